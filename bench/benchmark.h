@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+
+//------------------------------------------------------------------------
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+//------------------------------------------------------------------------
+//! Keeps the compiler from discarding a value that is never used.
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//------------------------------------------------------------------------
+//! Wall time of body(iterations) in nanoseconds.
+template <typename Body>
+inline double runNs(Body &body, int64_t iterations) {
+  auto start = Clock::now();
+  body(iterations);
+  return std::chrono::duration<double, std::nano>(Clock::now() - start)
+      .count();
+}
+
+//------------------------------------------------------------------------
+/** Nanoseconds per iteration of body(iterations), which runs its workload
+ *  that many times. The count is doubled until one run takes at least
+ *  minRunMs, the best of numRuns such runs is reported, which filters out
+ *  preemption and cold caches.
+ */
+template <typename Body>
+inline double nsPerIteration(Body &&body, double minRunMs = 50.,
+                             int numRuns = 5) {
+  int64_t iterations = 1;
+  while (runNs(body, iterations) < minRunMs * 1e6 &&
+         iterations < (int64_t{1} << 40))
+    iterations *= 2;
+
+  auto best = std::numeric_limits<double>::max();
+  for (int i = 0; i < numRuns; ++i)
+    best = std::min(best, runNs(body, iterations) / iterations);
+  return best;
+}
+
+//------------------------------------------------------------------------
+inline void report(const char *name, double nsPerOp, const char *unit = "op") {
+  std::printf("%-48s %12.1f ns/%s %14.0f %s/s\n", name, nsPerOp, unit,
+              nsPerOp > 0. ? 1e9 / nsPerOp : 0., unit);
+}
+
+//------------------------------------------------------------------------
+} // namespace Bench
@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "source/media/audioclient.h"
+#include "source/media/miditovst.h"
+#include <functional>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+//------------------------------------------------------------------------
+//! A dense controller stream: every channel, every controller, changing
+//! values, as from MPE controllers or a bank of 14-bit faders.
+static std::vector<IMidiClient::Event> makeControllerStream() {
+  std::vector<IMidiClient::Event> events;
+  for (int32 i = 0; i < kMaxMidiChannels * 128; ++i) {
+    IMidiClient::Event event{};
+    event.type = kController;
+    event.channel = static_cast<MidiData>(i % kMaxMidiChannels);
+    event.data0 = static_cast<MidiData>((i / kMaxMidiChannels) % 128);
+    event.data1 = static_cast<MidiData>((i * 7) % 128);
+    events.push_back(event);
+  }
+  return events;
+}
+
+//------------------------------------------------------------------------
+//! Controller conversion as it was before MidiCCMapping: out of line,
+//! through a std::function.
+using ToParameterIdFunc = std::function<ParamID(int32, int32)>;
+__attribute__((noinline)) static OptionParamChange
+referenceToParameter(MidiData channel, MidiData controller, MidiData value,
+                     const ToParameterIdFunc &toParamID) {
+  auto id = toParamID(channel, controller);
+  if (id == kNoParamId)
+    return {};
+  return ParameterChange{id, (double)value * kMidiScaler};
+}
+
+//------------------------------------------------------------------------
+int main() {
+  auto events = makeControllerStream();
+
+  MidiCCMapping mapping;
+  for (int32 channel = 0; channel < kMaxMidiChannels; ++channel)
+    for (int32 controller = 0; controller < kCountCtrlNumber; ++controller)
+      mapping.set(0, channel, controller, channel * 1000 + controller);
+  MidiInputChannels channels;
+
+  auto ns = Bench::nsPerIteration([&](int64_t iterations) {
+    int32 port = 0;
+    for (int64_t i = 0; i < iterations; ++i) {
+      const auto &event = events[i & (events.size() - 1)];
+      auto &input = channels[event.channel];
+      auto change = midiToParameter(
+          event.type, event.channel, event.data0, event.data1, input.state,
+          [&](int32 channel, int32 controller) {
+            return mapping.get(port, channel, controller);
+          },
+          [&](int32) { return input.program; });
+      Bench::doNotOptimize(change);
+    }
+  });
+  Bench::report("MidiCCMapping lookup", ns, "event");
+
+  // the nested vectors behind a std::function that MidiCCMapping replaced
+  std::vector<std::vector<std::vector<ParamID>>> nested(
+      kMaxMidiMappingBusses,
+      std::vector<std::vector<ParamID>>(
+          kMaxMidiChannels, std::vector<ParamID>(kCountCtrlNumber)));
+  for (int32 channel = 0; channel < kMaxMidiChannels; ++channel)
+    for (int32 controller = 0; controller < kCountCtrlNumber; ++controller)
+      nested[0][channel][controller] = channel * 1000 + controller;
+
+  ns = Bench::nsPerIteration([&](int64_t iterations) {
+    int32 port = 0;
+    for (int64_t i = 0; i < iterations; ++i) {
+      const auto &event = events[i & (events.size() - 1)];
+      ToParameterIdFunc toParamID = [&nested, port](int32 channel,
+                                                    int32 controller) {
+        return nested[port][channel][controller];
+      };
+      auto change = referenceToParameter(event.channel, event.data0,
+                                         event.data1, toParamID);
+      Bench::doNotOptimize(change);
+    }
+  });
+  Bench::report("std::function + nested vectors (reference)", ns, "event");
+  return 0;
+}
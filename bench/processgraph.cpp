@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "source/media/processgraph.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+//------------------------------------------------------------------------
+namespace {
+
+constexpr int32 kBlockSize = 128;
+constexpr int32 kNumChannels = 2;
+
+//------------------------------------------------------------------------
+/** A stand-in for a plug-in: a stereo one-pole filter run several times
+ *  per sample, so its cost is a fixed amount of arithmetic per block.
+ */
+class LoadClient : public IAudioClient {
+public:
+  explicit LoadClient(int32 workPerSample) : workPerSample(workPerSample) {}
+
+  bool process(Buffers &buffers, int64_t) override {
+    for (int32 channel = 0; channel < buffers.numOutputs; ++channel) {
+      const float *in = channel < buffers.numInputs ? buffers.inputs[channel]
+                                                    : nullptr;
+      float *out = buffers.outputs[channel];
+      float state = states[channel];
+      for (int32 i = 0; i < buffers.numSamples; ++i) {
+        float x = in ? in[i] : 0.f;
+        for (int32 k = 0; k < workPerSample; ++k)
+          state = state * 0.999f + x * 0.001f;
+        out[i] = state;
+      }
+      states[channel] = state;
+    }
+    return true;
+  }
+  bool setSamplerate(SampleRate) override { return true; }
+  bool setBlockSize(int32) override { return true; }
+  IOSetup getIOSetup() const override {
+    return {{"In L", "In R"}, {"Out L", "Out R"}};
+  }
+
+private:
+  int32 workPerSample;
+  float states[kNumChannels] = {};
+};
+
+//------------------------------------------------------------------------
+//! numChains independent chains of chainLength nodes each.
+ProcessGraphPtr makeGraph(int32 numChains, int32 chainLength,
+                          int32 workPerSample, int32 numWorkers) {
+  auto graph = std::make_shared<ProcessGraph>();
+  for (int32 chain = 0; chain < numChains; ++chain) {
+    ProcessGraph::NodeID previous = -1;
+    for (int32 i = 0; i < chainLength; ++i) {
+      auto node =
+          graph->addNode(std::make_shared<LoadClient>(workPerSample), nullptr);
+      if (previous >= 0)
+        graph->connect(previous, node);
+      previous = node;
+    }
+  }
+  std::string error;
+  if (!graph->start(nullptr, numWorkers, {}, error)) {
+    std::printf("start failed: %s\n", error.data());
+    return nullptr;
+  }
+  graph->setSamplerate(48000.);
+  graph->setBlockSize(kBlockSize);
+  return graph;
+}
+
+//------------------------------------------------------------------------
+//! One period of graph, ns per process() call.
+double measurePeriod(ProcessGraph &graph) {
+  float inputMemory[kNumChannels][kBlockSize] = {};
+  float outputMemory[kNumChannels][kBlockSize] = {};
+  float *inputs[kNumChannels] = {inputMemory[0], inputMemory[1]};
+  float *outputs[kNumChannels] = {outputMemory[0], outputMemory[1]};
+  IAudioClient::Buffers buffers{inputs,  kNumChannels, outputs,
+                                kNumChannels, kBlockSize};
+  int64_t frames = 0;
+  return Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      graph.process(buffers, frames);
+      frames += kBlockSize;
+    }
+    Bench::doNotOptimize(outputMemory);
+  });
+}
+
+//------------------------------------------------------------------------
+/** The same graph on 1..maxThreads threads. numWorkers counts the helpers
+ *  besides the server thread, so n threads means n - 1 workers.
+ */
+void benchScaling(const char *shape, int32 numChains, int32 chainLength,
+                  int32 workPerSample, int32 maxThreads) {
+  double singleThread = 0.;
+  for (int32 threads = 1; threads <= maxThreads; ++threads) {
+    auto graph = makeGraph(numChains, chainLength, workPerSample, threads - 1);
+    if (!graph)
+      return;
+    auto ns = measurePeriod(*graph);
+    if (threads == 1)
+      singleThread = ns;
+
+    auto name = std::string(shape) + ", " + std::to_string(threads) +
+                " thread" + (threads > 1 ? "s" : "");
+    Bench::report(name.data(), ns, "period");
+    std::printf("%-48s %12.2fx speedup\n", "", singleThread / ns);
+  }
+}
+
+} // namespace
+
+//------------------------------------------------------------------------
+//! The optional argument caps the thread count, the default is one per
+//! hardware thread.
+int main(int argc, char **argv) {
+  auto maxThreads =
+      static_cast<int32>(std::max(1u, std::thread::hardware_concurrency()));
+  if (argc > 1)
+    maxThreads = std::max(1, std::atoi(argv[1]));
+
+  // Light nodes measure the dispatch overhead, heavy nodes the scaling.
+  benchScaling("16 parallel nodes, light", 16, 1, 1, maxThreads);
+  benchScaling("16 parallel nodes, heavy", 16, 1, 64, maxThreads);
+  benchScaling("4 chains of 4 nodes, heavy", 4, 4, 64, maxThreads);
+  return 0;
+}
@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "source/media/sampleconvert.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+//------------------------------------------------------------------------
+/** Per block cost of the kSample64 path, which converts the inputs to
+ *  double and the outputs back, against the kSample32 path, whose only
+ *  cost is handing the server buffers through (a copy as upper bound).
+ */
+static void benchBlockSize(int32 blockSize) {
+  std::vector<Sample32> input(blockSize), output(blockSize);
+  std::vector<Sample64> buffer64(blockSize);
+  for (int32 i = 0; i < blockSize; ++i)
+    input[i] = static_cast<Sample32>(i % 100) * 0.01f;
+
+  auto prefix = std::to_string(blockSize) + " samples: ";
+  auto ns = Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      std::memcpy(output.data(), input.data(), blockSize * sizeof(Sample32));
+      Bench::doNotOptimize(output.data());
+    }
+  });
+  Bench::report((prefix + "32 bit copy").data(), ns, "block");
+
+  ns = Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      convertToSample64(input.data(), buffer64.data(), blockSize);
+      Bench::doNotOptimize(buffer64.data());
+      convertToSample32(buffer64.data(), output.data(), blockSize);
+      Bench::doNotOptimize(output.data());
+    }
+  });
+  Bench::report((prefix + "64 bit round trip").data(), ns, "block");
+
+  // what the kernels replace
+  ns = Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      for (int32 s = 0; s < blockSize; ++s) {
+        buffer64[s] = input[s];
+        Bench::doNotOptimize(buffer64[s]);
+      }
+      for (int32 s = 0; s < blockSize; ++s) {
+        output[s] = static_cast<Sample32>(buffer64[s]);
+        Bench::doNotOptimize(output[s]);
+      }
+    }
+  });
+  Bench::report((prefix + "64 bit round trip, scalar").data(), ns, "block");
+}
+
+//------------------------------------------------------------------------
+int main() {
+  for (auto blockSize : {32, 128, 512, 2048})
+    benchBlockSize(blockSize);
+  return 0;
+}
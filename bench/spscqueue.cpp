@@ -0,0 +1,121 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "source/media/imediaserver.h"
+#include "source/media/spscqueue.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace Steinberg::Vst;
+
+//------------------------------------------------------------------------
+//! The payload of AudioClient's event queue.
+struct QueuedEvent {
+  IMidiClient::Event event;
+  int32_t port;
+};
+
+//------------------------------------------------------------------------
+//! push() directly followed by pop() on one thread: the bare cost.
+static void benchSingleThread() {
+  SPSCQueue<QueuedEvent> queue(1024);
+  QueuedEvent in{{0x90, 0, 60, 100, 0}, 0};
+  QueuedEvent out{};
+  auto ns = Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      queue.push(in);
+      queue.pop(out);
+      Bench::doNotOptimize(out);
+    }
+  });
+  Bench::report("push + pop, one thread", ns, "event");
+}
+
+//------------------------------------------------------------------------
+/** A producer pushing as fast as it can against a consumer draining as
+ *  fast as it can, the sustained throughput. Full and empty queue attempts
+ *  are counted; both sides yield then, the producer retries like a sender
+ *  that must not drop.
+ */
+static void benchTwoThreads(size_t capacity) {
+  static const int64_t kNumEvents = 20000000;
+
+  SPSCQueue<QueuedEvent> queue(capacity);
+  std::atomic<bool> go{false};
+  int64_t full = 0;
+  int64_t empty = 0;
+  int64_t checksum = 0;
+
+  std::thread consumer([&]() {
+    while (!go.load(std::memory_order_acquire))
+      std::this_thread::yield();
+    QueuedEvent event;
+    for (int64_t received = 0; received < kNumEvents;) {
+      if (!queue.pop(event)) {
+        ++empty;
+        std::this_thread::yield();
+        continue;
+      }
+      checksum += event.event.timestamp;
+      ++received;
+    }
+  });
+
+  auto start = Bench::Clock::now();
+  go.store(true, std::memory_order_release);
+  QueuedEvent event{{0x90, 0, 60, 100, 0}, 0};
+  for (int64_t i = 0; i < kNumEvents; ++i) {
+    event.event.timestamp = i;
+    while (!queue.push(event)) {
+      ++full;
+      std::this_thread::yield();
+    }
+  }
+  consumer.join();
+  auto ns = std::chrono::duration<double, std::nano>(Bench::Clock::now() -
+                                                     start)
+                .count();
+
+  auto name = "two threads, capacity " + std::to_string(capacity);
+  Bench::report(name.data(), ns / kNumEvents, "event");
+  std::printf("%-48s %12lld full %12lld empty\n", "",
+              static_cast<long long>(full), static_cast<long long>(empty));
+  if (checksum != kNumEvents * (kNumEvents - 1) / 2)
+    std::printf("events were lost or reordered\n");
+}
+
+//------------------------------------------------------------------------
+int main() {
+  benchSingleThread();
+  for (auto capacity : {64, 1024, 16384})
+    benchTwoThreads(capacity);
+  return 0;
+}
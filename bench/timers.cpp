@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "bench/benchmark.h"
+#include "source/platform/linux/runloop.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Steinberg::Vst::EditorHost;
+
+//------------------------------------------------------------------------
+//! A tick with nothing due: the cost every run loop wake-up pays.
+static void benchIdleTick(int numTimers) {
+  TimerProcessor processor;
+  for (int i = 0; i < numTimers; ++i)
+    processor.registerTimer(60 * 1000, [](TimerID) {});
+
+  auto ns = Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i)
+      Bench::doNotOptimize(processor.handleTimersAndReturnNextFireTime());
+  });
+  auto name = "idle tick, " + std::to_string(numTimers) + " timers";
+  Bench::report(name.data(), ns, "tick");
+}
+
+//------------------------------------------------------------------------
+//! 1 ms timers registered at staggered times, so ticks fire a few of them
+//! each, like many meter timers of plug-in views.
+static void benchFiringTicks(int numTimers) {
+  TimerProcessor processor;
+  int64_t fired = 0;
+  for (int i = 0; i < numTimers; ++i) {
+    processor.registerTimer(1, [&](TimerID) { ++fired; });
+    std::this_thread::sleep_for(std::chrono::microseconds(1000 / numTimers));
+  }
+
+  int64_t ticks = 0;
+  fired = 0;
+  auto start = Bench::Clock::now();
+  auto end = start + std::chrono::milliseconds(500);
+  Bench::Clock::duration busy{};
+  while (Bench::Clock::now() < end) {
+    auto tickStart = Bench::Clock::now();
+    auto before = fired;
+    processor.handleTimersAndReturnNextFireTime();
+    if (fired != before) {
+      busy += Bench::Clock::now() - tickStart;
+      ++ticks;
+    }
+  }
+
+  auto busyNs = std::chrono::duration<double, std::nano>(busy).count();
+  auto name = "firing tick, " + std::to_string(numTimers) + " timers";
+  Bench::report(name.data(), ticks ? busyNs / ticks : 0., "tick");
+  name = "  per callback, " + std::to_string(numTimers) + " timers";
+  Bench::report(name.data(), fired ? busyNs / fired : 0., "call");
+}
+
+//------------------------------------------------------------------------
+static void benchRegisterUnregister(int numTimers) {
+  TimerProcessor processor;
+  for (int i = 0; i < numTimers; ++i)
+    processor.registerTimer(16 + i % 7, [](TimerID) {});
+
+  auto ns = Bench::nsPerIteration([&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i)
+      processor.unregisterTimer(processor.registerTimer(16, [](TimerID) {}));
+  });
+  auto name = "register + unregister, " + std::to_string(numTimers) +
+              " timers";
+  Bench::report(name.data(), ns, "pair");
+}
+
+//------------------------------------------------------------------------
+int main() {
+  for (auto numTimers : {10, 100, 1000}) {
+    benchIdleTick(numTimers);
+    benchFiringTicks(numTimers);
+    benchRegisterUnregister(numTimers);
+  }
+  return 0;
+}
@@ -0,0 +1,282 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/batchrender.h"
+#include "public.sdk/source/vst/hosting/module.h"
+#include "public.sdk/source/vst/hosting/plugprovider.h"
+#include "public.sdk/source/vst/vstpresetfile.h"
+#include "source/media/audioclient.h"
+#include "source/toml11/toml.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+//! Module entry points and plug-in setup are not expected to be reentrant,
+//! only processing runs concurrently.
+static std::mutex pluginMutex;
+
+//------------------------------------------------------------------------
+static const toml::value *findKey(const toml::value &job,
+                                  const toml::value &defaults,
+                                  const std::string &key) {
+  if (job.contains(key))
+    return &job.at(key);
+  if (defaults.is_table() && defaults.contains(key))
+    return &defaults.at(key);
+  return nullptr;
+}
+
+//------------------------------------------------------------------------
+static std::string getString(const toml::value &job,
+                             const toml::value &defaults,
+                             const std::string &key) {
+  auto value = findKey(job, defaults, key);
+  return value ? value->as_string() : std::string();
+}
+
+//------------------------------------------------------------------------
+static double getNumber(const toml::value &job, const toml::value &defaults,
+                        const std::string &key, double defaultValue) {
+  auto value = findKey(job, defaults, key);
+  if (!value)
+    return defaultValue;
+  if (value->is_integer())
+    return static_cast<double>(value->as_integer());
+  return value->as_floating();
+}
+
+//------------------------------------------------------------------------
+static std::string resolvePath(const std::string &directory,
+                               const std::string &path) {
+  if (path.empty() || path.front() == '/' || directory.empty())
+    return path;
+  return directory + "/" + path;
+}
+
+//------------------------------------------------------------------------
+bool readRenderJobs(const std::string &path, RenderJobs &jobs,
+                    std::string &error) {
+  jobs.clear();
+  auto slash = path.find_last_of('/');
+  auto directory =
+      slash == std::string::npos ? std::string() : path.substr(0, slash);
+
+  try {
+    auto root = toml::parse(path);
+    if (!root.contains("job")) {
+      error = path + ": no [[job]] tables";
+      return false;
+    }
+    for (const auto &table : root.at("job").as_array()) {
+      RenderJob job;
+      job.pluginPath = resolvePath(directory, getString(table, root, "plugin"));
+      job.uid = getString(table, root, "uid");
+      job.statePath = resolvePath(directory, getString(table, root, "state"));
+      job.doublePrecision = findKey(table, root, "double") &&
+                            findKey(table, root, "double")->as_boolean();
+
+      auto &setup = job.setup;
+      setup.inputPath = resolvePath(directory, getString(table, root, "input"));
+      setup.midiPath = resolvePath(directory, getString(table, root, "midi"));
+      setup.outputPath =
+          resolvePath(directory, getString(table, root, "output"));
+      setup.sampleRate = getNumber(table, root, "sample_rate", 0.);
+      setup.blockSize = static_cast<int32>(
+          getNumber(table, root, "block_size", setup.blockSize));
+      setup.rawInputChannels = static_cast<int32>(
+          getNumber(table, root, "input_channels", setup.rawInputChannels));
+      setup.durationSeconds = getNumber(table, root, "duration", 0.);
+      setup.tailSeconds = getNumber(table, root, "tail", 0.);
+
+      job.name = getString(table, root, "name");
+      if (job.name.empty())
+        job.name = setup.outputPath;
+      if (job.pluginPath.empty() || setup.outputPath.empty()) {
+        error = path + ": job " + std::to_string(jobs.size() + 1) +
+                " needs plugin and output";
+        return false;
+      }
+      jobs.push_back(std::move(job));
+    }
+  } catch (const std::exception &e) {
+    error = e.what();
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+//! One plug-in set up for rendering, torn down under pluginMutex.
+struct RenderInstance {
+  ~RenderInstance() {
+    std::lock_guard<std::mutex> lock(pluginMutex);
+    audioClient.reset();
+    mediaServer.reset();
+    controller = nullptr;
+    component = nullptr;
+    plugProvider = nullptr;
+    module.reset();
+  }
+
+  bool setup(const RenderJob &job, FUnknown *hostContext,
+             std::string &error);
+
+  VST3::Hosting::Module::Ptr module;
+  IPtr<PlugProvider> plugProvider;
+  IPtr<IComponent> component;
+  IPtr<IEditController> controller;
+  OfflineMediaServerPtr mediaServer;
+  AudioClientPtr audioClient;
+};
+
+//------------------------------------------------------------------------
+bool RenderInstance::setup(const RenderJob &job, FUnknown *hostContext,
+                           std::string &error) {
+  std::lock_guard<std::mutex> lock(pluginMutex);
+  module = VST3::Hosting::Module::create(job.pluginPath, error);
+  if (!module)
+    return false;
+
+  auto factory = module->getFactory();
+  if (hostContext)
+    factory.setHostContext(hostContext);
+  auto uid = job.uid.empty() ? VST3::Optional<VST3::UID>()
+                             : VST3::UID::fromString(job.uid);
+  if (!job.uid.empty() && !uid) {
+    error = "Invalid uid " + job.uid;
+    return false;
+  }
+  VST3::Optional<VST3::UID> classID;
+  for (auto &classInfo : factory.classInfos()) {
+    if (classInfo.category() != kVstAudioEffectClass)
+      continue;
+    if (uid && *uid != classInfo.ID())
+      continue;
+    plugProvider = owned(new PlugProvider(factory, classInfo, true));
+    if (!plugProvider->initialize()) {
+      error = "Could not initialize " + classInfo.name();
+      return false;
+    }
+    classID = classInfo.ID();
+    break;
+  }
+  if (!plugProvider) {
+    error = "No VST3 Audio Module Class found in " + job.pluginPath;
+    return false;
+  }
+  component = owned(plugProvider->getComponent());
+  controller = owned(plugProvider->getController());
+
+  if (!job.statePath.empty()) {
+    auto stream = owned(FileStream::open(job.statePath.data(), "rb"));
+    if (!stream) {
+      error = "Could not open " + job.statePath;
+      return false;
+    }
+    if (!PresetFile::loadPreset(stream, FUID::fromTUID(classID->data()),
+                                component, controller)) {
+      error = "Could not load " + job.statePath;
+      return false;
+    }
+  }
+
+  mediaServer = createOfflineMediaServer(job.setup, error);
+  if (!mediaServer)
+    return false;
+
+  AudioClientOptions options;
+  options.processMode = kOffline;
+  if (job.doublePrecision)
+    options.symbolicSampleSize = kSample64;
+  audioClient = AudioClient::create(job.name, component, controller,
+                                    mediaServer, options);
+  if (!audioClient) {
+    error = "Could not set up processing";
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+} // namespace
+
+//------------------------------------------------------------------------
+static void renderJob(const RenderJob &job, FUnknown *hostContext,
+                      RenderResult &result) {
+  RenderInstance instance;
+  if (!instance.setup(job, hostContext, result.error))
+    return;
+
+  auto start = std::chrono::steady_clock::now();
+  result.success = instance.mediaServer->run(result.error);
+  result.renderSeconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  result.renderedFrames = instance.mediaServer->getRenderedFrames();
+  result.sampleRate = instance.mediaServer->getSampleRate();
+}
+
+//------------------------------------------------------------------------
+RenderResults renderJobs(const RenderJobs &jobs, int32 numWorkers,
+                         FUnknown *hostContext) {
+  RenderResults results(jobs.size());
+  if (numWorkers <= 0)
+    numWorkers = static_cast<int32>(std::max(sysconf(_SC_NPROCESSORS_ONLN),
+                                             1L));
+  auto numThreads = std::min<size_t>(static_cast<size_t>(numWorkers),
+                                     jobs.size());
+
+  std::atomic<size_t> nextJob{0};
+  auto work = [&]() {
+    for (auto i = nextJob++; i < jobs.size(); i = nextJob++)
+      renderJob(jobs[i], hostContext, results[i]);
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < numThreads; ++i)
+    threads.emplace_back(work);
+  work();
+  for (auto &thread : threads)
+    thread.join();
+  return results;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
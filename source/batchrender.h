@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pluginterfaces/base/funknown.h"
+#include "source/media/offline/offlineserver.h"
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+//! One [[job]] of a render job file.
+struct RenderJob {
+  std::string name;
+  std::string pluginPath;
+  //! Class ID of the audio module class, the first one when empty.
+  std::string uid;
+  //! .vstpreset applied to the plug-in before rendering.
+  std::string statePath;
+  bool doublePrecision = false;
+  OfflineSetup setup;
+};
+
+using RenderJobs = std::vector<RenderJob>;
+
+//------------------------------------------------------------------------
+struct RenderResult {
+  bool success = false;
+  std::string error;
+  int64 renderedFrames = 0;
+  SampleRate sampleRate = 0;
+  //! Wall clock time of the render loop, without loading the plug-in.
+  double renderSeconds = 0.;
+
+  double getAudioSeconds() const {
+    return sampleRate > 0 ? static_cast<double>(renderedFrames) / sampleRate
+                          : 0.;
+  }
+  double getRealtimeFactor() const {
+    return renderSeconds > 0 ? getAudioSeconds() / renderSeconds : 0.;
+  }
+};
+
+using RenderResults = std::vector<RenderResult>;
+
+//------------------------------------------------------------------------
+/** Reads a TOML render job file.
+ *
+ *  Every [[job]] table describes one render, keys at the top level are
+ *  defaults for all jobs. Relative paths are relative to the job file.
+ *
+ *  plugin, output   required, path of the .vst3 bundle and the output file
+ *  uid              class ID of the plug-in
+ *  state            .vstpreset file
+ *  input            WAV or raw float32 input, silence when missing
+ *  input_channels   channel count of raw input
+ *  midi             Standard MIDI File played to the plug-in
+ *  sample_rate      taken from the input when missing
+ *  block_size       512 when missing
+ *  duration, tail   seconds to render without audio input (the MIDI file
+ *                   length by default), seconds after the input
+ *  double           process in 64 bit if the plug-in supports it
+ *  name             shown in the summary, defaults to output
+ */
+bool readRenderJobs(const std::string &path, RenderJobs &jobs,
+                    std::string &error);
+
+/** Renders jobs on numWorkers threads, each rendering one job with its own
+ *  plug-in instance at a time. Loading and unloading plug-ins is serialized,
+ *  processing runs in parallel. numWorkers 0 means one per CPU.
+ */
+RenderResults renderJobs(const RenderJobs &jobs, int32 numWorkers,
+                         FUnknown *hostContext);
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -35,8 +35,15 @@
 #include "pluginterfaces/vst/ivstaudioprocessor.h"
 #include "pluginterfaces/vst/ivsteditcontroller.h"
 #include "pluginterfaces/vst/vsttypes.h"
+#include "source/media/iparameterclient.h"
 #include "source/platform/appinit.h"
 #include <cstdio>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <limits>
 
 //------------------------------------------------------------------------
 namespace Steinberg {
@@ -102,22 +109,38 @@ private:
 //------------------------------------------------------------------------
 class ComponentHandler : public IComponentHandler {
 public:
+  using RestartFunc = std::function<bool(int32 flags)>;
+
+  //! Edits are forwarded to parameterClient, restartComponent to restart.
+  void connect(IParameterClientPtr client, RestartFunc func) {
+    parameterClient = std::move(client);
+    restart = std::move(func);
+  }
+
   tresult PLUGIN_API beginEdit(ParamID id) override {
     SMTG_DBPRT1("beginEdit called (%d)\n", id);
-    return kNotImplemented;
+    return kResultOk;
   }
+  //! Edits of one parameter within a block end up at the same sample
+  //! offset, where the ParamValueQueue keeps only the latest value.
   tresult PLUGIN_API performEdit(ParamID id,
                                  ParamValue valueNormalized) override {
     SMTG_DBPRT2("performEdit called (%d, %f)\n", id, valueNormalized);
-    return kNotImplemented;
+    auto client = parameterClient.lock();
+    if (!client)
+      return kNotInitialized;
+    client->setParameter(id, valueNormalized, 0);
+    return kResultOk;
   }
   tresult PLUGIN_API endEdit(ParamID id) override {
     SMTG_DBPRT1("endEdit called (%d)\n", id);
-    return kNotImplemented;
+    return kResultOk;
   }
   tresult PLUGIN_API restartComponent(int32 flags) override {
     SMTG_DBPRT1("restartComponent called (%d)\n", flags);
-    return kNotImplemented;
+    if (!restart)
+      return kNotImplemented;
+    return restart(flags) ? kResultOk : kResultFalse;
   }
 
 private:
@@ -129,27 +152,105 @@ private:
   // not destroy this class!
   uint32 PLUGIN_API addRef() override { return 1000; }
   uint32 PLUGIN_API release() override { return 1000; }
+
+  IParameterClientPtr parameterClient;
+  RestartFunc restart;
 };
 
 static ComponentHandler gComponentHandler;
 
+static constexpr uint64 kControllerUpdateIntervalMs = 16;
+
+//------------------------------------------------------------------------
+//! Parses all of text as a decimal integer.
+static bool parseInteger(const std::string &text, int64_t &value) {
+  if (text.empty())
+    return false;
+  char *end = nullptr;
+  errno = 0;
+  auto result = std::strtoll(text.data(), &end, 10);
+  if (errno != 0 || end != text.data() + text.size())
+    return false;
+  value = result;
+  return true;
+}
+
+#if MIN_VST_HOST_WITH_AUDIO
+//------------------------------------------------------------------------
+//! The getters of the audio settings exit naming the key if a value from
+//! the config file has the wrong type.
+static int64_t getIntegerSetting(const toml::value &settings,
+                                 const std::string &key,
+                                 int64_t defaultValue) {
+  if (!settings.contains(key))
+    return defaultValue;
+  const auto &value = settings.at(key);
+  if (!value.is_integer())
+    IPlatform::instance().kill(-1, "audio setting " + key +
+                                       " must be an integer");
+  return value.as_integer();
+}
+
+//------------------------------------------------------------------------
+static bool getBoolSetting(const toml::value &settings,
+                           const std::string &key) {
+  if (!settings.contains(key))
+    return false;
+  const auto &value = settings.at(key);
+  if (!value.is_boolean())
+    IPlatform::instance().kill(-1, "audio setting " + key +
+                                       " must be true or false");
+  return value.as_boolean();
+}
+
+//------------------------------------------------------------------------
+static std::string getStringSetting(const toml::value &settings,
+                                    const std::string &key) {
+  if (!settings.contains(key))
+    return {};
+  const auto &value = settings.at(key);
+  if (!value.is_string())
+    IPlatform::instance().kill(-1, "audio setting " + key +
+                                       " must be a string");
+  return value.as_string();
+}
+#endif
+
 //------------------------------------------------------------------------
 App::~App() noexcept { terminate(); }
 
 //------------------------------------------------------------------------
-void App::openEditor(const std::string &path,
-                     VST3::Optional<VST3::UID> effectID, uint32 flags) {
+void App::loadPlugin(const std::string &path,
+                     const VST3::Optional<VST3::UID> &effectID,
+                     VST3::Hosting::Module::Ptr &pluginModule,
+                     IPtr<PlugProvider> &provider) {
   std::string error;
-  module = VST3::Hosting::Module::create(path, error);
-  if (!module) {
+  // a current cache entry or moduleinfo.json answer this without dlopen
+  auto cached = scanCache.find(path);
+  if (!cached) {
+    ScannedModule moduleInfo;
+    if (scanModuleInfo(path, moduleInfo)) {
+      scanCache.store(std::move(moduleInfo));
+      cached = scanCache.find(path);
+    }
+  }
+  if (cached && effectID && !cached->findClass(effectID->toString()))
+    IPlatform::instance().kill(-1, "No class with UID " +
+                                       effectID->toString() + " in file " +
+                                       path);
+
+  pluginModule = VST3::Hosting::Module::create(path, error);
+  if (!pluginModule) {
     std::string reason = "Could not create Module for file:";
     reason += path;
     reason += "\nError: ";
     reason += error;
     IPlatform::instance().kill(-1, reason);
   }
+  // a missing or stale entry is filled from the module just loaded
+  auto scanned = scanCache.update(path, *pluginModule, error);
 
-  auto factory = module->getFactory();
+  auto factory = pluginModule->getFactory();
   if (auto factoryHostContext = IPlatform::instance().getPluginFactoryContext())
     factory.setHostContext(factoryHostContext);
   for (auto &classInfo : factory.classInfos()) {
@@ -158,13 +259,23 @@ void App::openEditor(const std::string &path,
         if (*effectID != classInfo.ID())
           continue;
       }
-      plugProvider = owned(new PlugProvider(factory, classInfo, true));
-      if (plugProvider->initialize() == false)
-        plugProvider = nullptr;
+      provider = owned(new PlugProvider(factory, classInfo, true));
+      if (provider->initialize() == false) {
+        provider = nullptr;
+        break;
+      }
+      auto scannedClass =
+          scanned ? scanned->findClass(classInfo.ID().toString()) : nullptr;
+      if (scannedClass && !scannedClass->isProbed()) {
+        auto component = owned(provider->getComponent());
+        auto controller = owned(provider->getController());
+        probeScannedClass(component, controller, *scannedClass);
+        scanCache.setModified();
+      }
       break;
     }
   }
-  if (!plugProvider) {
+  if (!provider) {
     if (effectID)
       error = "No VST3 Audio Module Class with UID " + effectID->toString() +
               " found in file ";
@@ -173,7 +284,14 @@ void App::openEditor(const std::string &path,
     error += path;
     IPlatform::instance().kill(-1, error);
   }
+}
+
+//------------------------------------------------------------------------
+void App::openEditor(const std::string &path,
+                     VST3::Optional<VST3::UID> effectID, uint32 flags) {
+  loadPlugin(path, effectID, module, plugProvider);
 
+  std::string error;
   auto editController = plugProvider->getController();
   if (!editController) {
     error =
@@ -182,11 +300,14 @@ void App::openEditor(const std::string &path,
   }
   editController->release(); // plugProvider does an addRef
 
-  if (flags & kSetComponentHandler) {
+  if (flags & (kSetComponentHandler | kStartAudio)) {
     SMTG_DBPRT0("setComponentHandler is used\n");
     editController->setComponentHandler(&gComponentHandler);
   }
 
+  if (flags & kStartAudio)
+    startAudioProcessing(module->getName(), flags);
+
   SMTG_DBPRT1("Open Editor for %s...\n", path.c_str());
   createViewAndShow(editController);
 
@@ -196,6 +317,184 @@ void App::openEditor(const std::string &path,
   }
 }
 
+//------------------------------------------------------------------------
+void App::startAudioProcessing(const std::string &name, uint32 flags) {
+#if MIN_VST_HOST_WITH_AUDIO
+  auto component = plugProvider->getComponent();
+  if (!component)
+    IPlatform::instance().kill(-1, "No Component found for " + name);
+  component->release(); // plugProvider does an addRef
+
+  auto editController = plugProvider->getController();
+  if (editController)
+    editController->release(); // plugProvider does an addRef
+
+  AudioClientOptions options;
+  if (flags & kDoublePrecision)
+    options.symbolicSampleSize = kSample64;
+  auto subBlockSize = getIntegerSetting(audioSettings, "sub_block", 0);
+  if (subBlockSize < 0 || subBlockSize > std::numeric_limits<int32>::max())
+    IPlatform::instance().kill(-1, "wrong sub block size");
+  options.subBlockSize = static_cast<int32>(subBlockSize);
+  options.countPageFaults = getBoolSetting(audioSettings, "page_faults");
+  options.realtime.lockMemory = getBoolSetting(audioSettings, "mlock");
+  auto prefaultMB = getIntegerSetting(audioSettings, "prefault_mb", 0);
+  if (prefaultMB < 0 || prefaultMB > (int64_t{1} << 32))
+    IPlatform::instance().kill(-1, "wrong prefault size");
+  options.realtime.prefaultHeapBytes = static_cast<size_t>(prefaultMB) << 20;
+  auto priority = getIntegerSetting(audioSettings, "rt_priority", 0);
+  if (priority < 0 || priority > 99)
+    IPlatform::instance().kill(-1, "wrong realtime priority");
+  options.realtime.priority = static_cast<int32>(priority);
+  if (audioSettings.contains("cpus") &&
+      !parseCpuList(getStringSetting(audioSettings, "cpus"),
+                    options.realtime.cpus))
+    IPlatform::instance().kill(-1, "wrong cpu list");
+
+  if (chainPaths.empty() && parallelPaths.empty())
+    audioClient = AudioClient::create(name, component, editController, options);
+  else
+    audioClient = startAudioGraph(name, component, editController, options);
+  if (!audioClient)
+    IPlatform::instance().kill(-1, "Could not start audio processing for " +
+                                       name + " (is a JACK server running?)");
+  if (audioClient->getSymbolicSampleSize() != options.symbolicSampleSize)
+    std::printf("%s does not support 64 bit processing\n", name.data());
+
+  std::weak_ptr<AudioClient> client = audioClient;
+  gComponentHandler.connect(client, [client](int32 restartFlags) {
+    auto strongClient = client.lock();
+    return strongClient && strongClient->restart(restartFlags);
+  });
+
+  // output parameter changes (meters etc.) at display rate
+  controllerUpdateTimer = IPlatform::instance().registerTimer(
+      kControllerUpdateIntervalMs, [this]() {
+        if (audioClient)
+          audioClient->updateController();
+      });
+#else
+  (void)flags;
+  IPlatform::instance().kill(
+      -1, "Audio processing is not available in this build (" + name + ")");
+#endif
+}
+
+#if MIN_VST_HOST_WITH_AUDIO
+//------------------------------------------------------------------------
+AudioClientPtr App::createExtraPlugin(const std::string &path,
+                                      const AudioClientOptions &options) {
+  ExtraPlugin plugin;
+  loadPlugin(path, {}, plugin.module, plugin.plugProvider);
+  auto component = plugin.plugProvider->getComponent();
+  if (!component)
+    IPlatform::instance().kill(-1, "No Component found in file " + path);
+  component->release(); // plugProvider does an addRef
+  auto editController = plugin.plugProvider->getController();
+  if (editController)
+    editController->release(); // plugProvider does an addRef
+
+  auto client = AudioClient::create(plugin.module->getName(), component,
+                                    editController, nullptr, options);
+  if (!client)
+    IPlatform::instance().kill(-1, "Could not initialize " + path);
+  extraPlugins.push_back(std::move(plugin));
+  return client;
+}
+
+//------------------------------------------------------------------------
+AudioClientPtr App::startAudioGraph(const std::string &name,
+                                    IComponent *component,
+                                    IEditController *editController,
+                                    const AudioClientOptions &options) {
+  // The edited plug-in is the first stage, the --chain plug-ins follow.
+  auto first = AudioClient::create(name, component, editController, nullptr,
+                                   options);
+  if (!first)
+    return nullptr;
+
+  PluginChain::Stages stages{first};
+  for (const auto &path : chainPaths)
+    stages.push_back(createExtraPlugin(path, options));
+
+  auto server = createMediaServer(name, options.realtime);
+  if (!server)
+    return nullptr;
+  if (parallelPaths.empty()) {
+    audioChain = PluginChain::create(stages, server);
+    return audioChain ? first : nullptr;
+  }
+
+  // The chain and every --parallel plug-in run as independent graph nodes.
+  audioChain = PluginChain::create(stages, nullptr);
+  if (!audioChain)
+    return nullptr;
+  audioGraph = std::make_shared<ProcessGraph>();
+  audioGraph->addNode(audioChain, audioChain.get());
+  for (const auto &path : parallelPaths) {
+    auto client = createExtraPlugin(path, options);
+    audioGraph->addNode(client, client.get());
+  }
+
+  auto numNodes = static_cast<int64_t>(parallelPaths.size()) + 1;
+  auto numWorkers = getIntegerSetting(audioSettings, "threads", numNodes - 1);
+  if (numWorkers < 0 || numWorkers > std::numeric_limits<int32>::max())
+    IPlatform::instance().kill(-1, "wrong number of threads");
+  std::string error;
+  if (!audioGraph->start(server, static_cast<int32>(numWorkers),
+                         options.realtime, error)) {
+    std::printf("%s\n", error.data());
+    return nullptr;
+  }
+  return first;
+}
+#endif
+
+//------------------------------------------------------------------------
+void App::startStatisticsReport(uint64 intervalMs) {
+  statisticsTimer = IPlatform::instance().registerTimer(
+      intervalMs, [this]() { reportStatistics(); });
+}
+
+//------------------------------------------------------------------------
+void App::reportStatistics() {
+#if MIN_VST_HOST_WITH_AUDIO
+  if (!audioClient)
+    return;
+
+  auto stats = audioClient->getProcessStatistics().snapshot();
+  if (stats.numBlocks == 0)
+    return;
+
+  auto percentOfBudget = [&](double value) {
+    return stats.budget > 0. ? value * 100. / stats.budget : 0.;
+  };
+  std::printf("process: %llu blocks, p50 %.1fus, p99 %.1fus (%.1f%%), "
+              "p99.9 %.1fus (%.1f%%), max %.1fus (%.1f%% of %.1fus)\n",
+              static_cast<unsigned long long>(stats.numBlocks), stats.p50,
+              stats.p99, percentOfBudget(stats.p99), stats.p999,
+              percentOfBudget(stats.p999), stats.max, stats.maxLoad * 100.,
+              stats.budget);
+  if (stats.rtUnsafeBlocks)
+    std::printf("rt unsafe: %llu blocks, %llu allocations, "
+                "%llu deallocations, %llu locks, max %llu per block\n",
+                static_cast<unsigned long long>(stats.rtUnsafeBlocks),
+                static_cast<unsigned long long>(stats.rtAllocations),
+                static_cast<unsigned long long>(stats.rtDeallocations),
+                static_cast<unsigned long long>(stats.rtLocks),
+                static_cast<unsigned long long>(stats.rtMaxCallsPerBlock));
+  if (stats.pageFaults)
+    std::printf("page faults: %llu, max %llu per block\n",
+                static_cast<unsigned long long>(stats.pageFaults),
+                static_cast<unsigned long long>(stats.maxPageFaultsPerBlock));
+  if (stats.droppedParameterChanges || stats.droppedEvents)
+    std::printf("dropped: %llu parameter changes, %llu events\n",
+                static_cast<unsigned long long>(stats.droppedParameterChanges),
+                static_cast<unsigned long long>(stats.droppedEvents));
+  std::fflush(stdout);
+#endif
+}
+
 //------------------------------------------------------------------------
 void App::createViewAndShow(IEditController *controller) {
   auto view = owned(controller->createView(ViewType::kEditor));
@@ -223,16 +522,169 @@ void App::createViewAndShow(IEditController *controller) {
   window->show();
 }
 
+#if MIN_VST_HOST_WITH_AUDIO
+//------------------------------------------------------------------------
+void App::renderJobFile(const std::string &path, int32 numWorkers) {
+  RenderJobs jobs;
+  std::string error;
+  if (!readRenderJobs(path, jobs, error))
+    IPlatform::instance().kill(-1, error);
+
+  auto start = std::chrono::steady_clock::now();
+  auto results = renderJobs(jobs, numWorkers,
+                            IPlatform::instance().getPluginFactoryContext());
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  size_t numFailed = 0;
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    const auto &result = results[i];
+    if (!result.success) {
+      ++numFailed;
+      std::printf("FAILED %s: %s\n", jobs[i].name.data(),
+                  result.error.data());
+      continue;
+    }
+    std::printf("%s: %.1f s audio in %.2f s, %.1fx realtime\n",
+                jobs[i].name.data(), result.getAudioSeconds(),
+                result.renderSeconds, result.getRealtimeFactor());
+  }
+  std::printf("Rendered %zu of %zu jobs in %.1f s\n", jobs.size() - numFailed,
+              jobs.size(), seconds);
+}
+#endif
+
+//------------------------------------------------------------------------
+void App::scanPluginDirectories(const std::vector<std::string> &directories,
+                                const PluginScanOptions &options) {
+  std::vector<std::string> paths;
+  for (const auto &directory : directories) {
+    auto found = findModulePaths(directory);
+    paths.insert(paths.end(), found.begin(), found.end());
+  }
+  std::printf("Scanning %zu modules...\n", paths.size());
+
+  auto start = std::chrono::steady_clock::now();
+  auto reports = scanPlugins(paths, scanCache, options);
+  auto seconds = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  // slowest first, those are the ones delaying host startup
+  std::stable_sort(reports.begin(), reports.end(),
+                   [](const auto &a, const auto &b) {
+                     return a.loadTimeMs > b.loadTimeMs;
+                   });
+  size_t counts[5] = {};
+  std::printf("%10s %10s %8s  %s\n", "load ms", "total ms", "classes",
+              "module");
+  for (const auto &report : reports) {
+    ++counts[static_cast<size_t>(report.status)];
+    if (report.loadTimeMs < 0.)
+      continue;
+    std::printf("%10.1f %10.1f %8zu  %s%s\n", report.loadTimeMs,
+                report.totalTimeMs, report.numClasses, report.path.data(),
+                report.status == PluginScanReport::Status::kCached
+                    ? " (cached)"
+                    : "");
+  }
+  for (const auto &report : reports) {
+    if (report.loadTimeMs < 0.)
+      std::printf("FAILED %s: %s\n", report.path.data(), report.error.data());
+  }
+
+  using Status = PluginScanReport::Status;
+  std::printf("Scanned %zu modules in %.1f s: %zu scanned, %zu cached, "
+              "%zu failed, %zu crashed, %zu timed out\n",
+              reports.size(), seconds,
+              counts[static_cast<size_t>(Status::kScanned)],
+              counts[static_cast<size_t>(Status::kCached)],
+              counts[static_cast<size_t>(Status::kFailed)],
+              counts[static_cast<size_t>(Status::kCrashed)],
+              counts[static_cast<size_t>(Status::kTimedOut)]);
+}
+
 //------------------------------------------------------------------------
 void App::init(const std::vector<std::string> &cmdArgs) {
   VST3::Optional<VST3::UID> uid;
   uint32 flags{};
-  for (auto it = cmdArgs.begin(), end = cmdArgs.end(); it != end; ++it) {
-    if (*it == "--componentHandler")
+  uint64 statsInterval{0};
+  std::string configPath;
+  auto scanCachePath = ScanCache::defaultPath();
+  std::vector<std::string> scanDirectories;
+  PluginScanOptions scanOptions;
+  std::string renderPath;
+  int32 renderWorkers = 0;
+  auto it = cmdArgs.begin();
+  auto end = cmdArgs.end();
+  auto nextArgument = [&]() {
+    auto option = *it;
+    if (++it == end || it->empty())
+      IPlatform::instance().kill(-1, "missing argument to " + option);
+    return *it;
+  };
+  auto nextInteger = [&](int64_t minValue) {
+    auto option = *it;
+    int64_t value = 0;
+    if (++it == end || !parseInteger(*it, value) || value < minValue ||
+        value > std::numeric_limits<int32>::max())
+      IPlatform::instance().kill(-1, "wrong argument to " + option);
+    return value;
+  };
+  for (; it != end; ++it) {
+    if (*it == "--componentHandler") {
       flags |= kSetComponentHandler;
-    else if (*it == "--secondWindow")
+    } else if (*it == "--secondWindow") {
       flags |= kSecondWindow;
-    else if (*it == "--uid") {
+    } else if (*it == "--audio") {
+      flags |= kStartAudio;
+    } else if (*it == "--double") {
+      flags |= kDoublePrecision;
+    } else if (*it == "--stats") {
+      statsInterval = static_cast<uint64>(nextInteger(1));
+    } else if (*it == "--rtBacktraces") {
+      auto count = static_cast<uint32>(nextInteger(1));
+#if MIN_VST_HOST_WITH_AUDIO
+      RTGuard::enableBacktraces(count);
+#else
+      (void)count;
+#endif
+    } else if (*it == "--subBlock") {
+      audioSettings["sub_block"] = nextInteger(0);
+    } else if (*it == "--mlock") {
+      audioSettings["mlock"] = true;
+    } else if (*it == "--prefault") {
+      audioSettings["prefault_mb"] = nextInteger(0);
+    } else if (*it == "--cpus") {
+      audioSettings["cpus"] = nextArgument();
+    } else if (*it == "--rtPriority") {
+      audioSettings["rt_priority"] = nextInteger(0);
+    } else if (*it == "--pageFaults") {
+      audioSettings["page_faults"] = true;
+    } else if (*it == "--chain") {
+      chainPaths.push_back(nextArgument());
+    } else if (*it == "--parallel") {
+      parallelPaths.push_back(nextArgument());
+    } else if (*it == "--threads") {
+      audioSettings["threads"] = nextInteger(0);
+    } else if (*it == "--config") {
+      configPath = nextArgument();
+    } else if (*it == "--scanCache") {
+      scanCachePath = nextArgument();
+    } else if (*it == "--scan") {
+      scanDirectories.push_back(nextArgument());
+    } else if (*it == "--scanJobs") {
+      scanOptions.numWorkers = static_cast<int32>(nextInteger(1));
+    } else if (*it == "--scanTimeout") {
+      scanOptions.timeoutMs = static_cast<int32>(nextInteger(1));
+    } else if (*it == "--rescan") {
+      scanOptions.rescan = true;
+    } else if (*it == "--render") {
+      renderPath = nextArgument();
+    } else if (*it == "--renderJobs") {
+      renderWorkers = static_cast<int32>(nextInteger(1));
+    } else if (*it == "--uid") {
       if (++it != end)
         uid = VST3::UID::fromString(*it);
       if (!uid)
@@ -240,35 +692,175 @@ void App::init(const std::vector<std::string> &cmdArgs) {
     }
   }
 
-  if (cmdArgs.empty() || cmdArgs.back().find(".vst3") == std::string::npos) {
+  std::string error;
+  if (!scanCache.load(scanCachePath, error))
+    std::printf("Ignoring scan cache: %s\n", error.data());
+
+  if (!renderPath.empty()) {
+#if MIN_VST_HOST_WITH_AUDIO
+    PluginContextFactory::instance().setPluginContext(&pluginContext);
+    renderJobFile(renderPath, renderWorkers);
+    return;
+#else
+    (void)renderWorkers;
+    IPlatform::instance().kill(-1, "--render needs the audio engine");
+#endif
+  }
+
+  if (!scanDirectories.empty()) {
+    PluginContextFactory::instance().setPluginContext(&pluginContext);
+    scanOptions.hostContext = IPlatform::instance().getPluginFactoryContext();
+    scanPluginDirectories(scanDirectories, scanOptions);
+    if (!scanCache.save(error))
+      IPlatform::instance().kill(-1, "Could not save scan cache: " + error);
+    return;
+  }
+
+  std::string pluginPath;
+  if (!cmdArgs.empty() && cmdArgs.back().find(".vst3") != std::string::npos)
+    pluginPath = cmdArgs.back();
+  else if (uid) {
+    if (auto scanned = scanCache.findModuleOfClass(uid->toString()))
+      pluginPath = scanned->path;
+  }
+
+  if (pluginPath.empty()) {
     auto helpText = R"(
 usage: EditorHost [options] pluginPath
+       EditorHost [options] --uid UID
+       EditorHost --scan DIR [--scanJobs N] [--scanTimeout MS] [--rescan]
+       EditorHost --render FILE [--renderJobs N]
 
 options:
 
 --componentHandler
-  set optional component handler on edit controller
+  set optional component handler on edit controller (implied by --audio)
 
 --secondWindow
   create a second window
 
+--audio
+  process audio through JACK while the editor is open
+
+--double
+  process in 64 bit if the plug-in supports it (with --audio)
+
+--chain PATH
+  process the output of the plug-in through the plug-in at PATH in the same
+  JACK client, can be given several times (with --audio)
+
+--parallel PATH
+  process the input through the plug-in at PATH in parallel to the plug-in
+  (and its --chain) and mix the outputs, can be given several times
+  (with --audio)
+
+--threads N
+  worker threads for --parallel, default one per additional plug-in
+
+--stats MS
+  print process() timing percentiles every MS milliseconds (with --audio)
+
+--subBlock N
+  split each audio period into blocks of at most N samples (with --audio)
+
+--mlock
+  lock all memory of the process (with --audio)
+
+--prefault MB
+  prefault MB of heap for the plug-in and keep it (with --audio)
+
+--cpus LIST
+  pin the audio thread to the CPUs in LIST, e.g. 2,3 or 0-3 (with --audio)
+
+--rtPriority N
+  run the audio thread with SCHED_FIFO priority N (with --audio)
+
+--pageFaults
+  count page faults of the audio thread per block for --stats
+
+--config FILE
+  read the options above from the [audio] table of the TOML file FILE, using
+  the keys sub_block, mlock, prefault_mb, cpus, rt_priority, page_faults and
+  threads
+
+--rtBacktraces N
+  print a backtrace for the first N allocations or locks on the audio thread
+  (needs a build with MIN_VST_HOST_RT_GUARD)
+
 --uid UID
-  use effect class with unique class ID==UID
+  use effect class with unique class ID==UID, the plug-in path may be
+  omitted if the class is in the scan cache
+
+--scanCache FILE
+  plug-in scan cache to use instead of ~/.cache/min-vst-host/scancache
+
+--scan DIR
+  scan all plug-ins below DIR into the scan cache and report their load
+  times, can be given several times; works without X server
+
+--scanJobs N
+  number of scan worker processes, default one per CPU
+
+--scanTimeout MS
+  kill a scan worker that takes longer than MS milliseconds, default 30000
+
+--rescan
+  scan plug-ins again that have a current scan cache entry
+
+--render FILE
+  render the [[job]] tables of the TOML file FILE offline and print the
+  realtime factor of each job; works without X server
+
+--renderJobs N
+  number of jobs rendered in parallel, default one per CPU
 )";
 
     IPlatform::instance().kill(0, helpText);
   }
 
+  if (!configPath.empty()) {
+    try {
+      auto config = toml::parse(configPath);
+      // command line options take precedence over the config file
+      if (config.contains("audio")) {
+        for (const auto &entry : config.at("audio").as_table())
+          audioSettings.as_table().insert(entry);
+      }
+    } catch (const std::exception &e) {
+      IPlatform::instance().kill(-1, e.what());
+    }
+  }
+
   PluginContextFactory::instance().setPluginContext(&pluginContext);
 
-  openEditor(cmdArgs.back(), std::move(uid), flags);
+  openEditor(pluginPath, std::move(uid), flags);
+  if (!scanCache.save(error))
+    std::printf("Could not save scan cache: %s\n", error.data());
+
+  if (statsInterval)
+    startStatisticsReport(statsInterval);
 }
 
 //------------------------------------------------------------------------
 void App::terminate() {
+  if (statisticsTimer) {
+    IPlatform::instance().unregisterTimer(statisticsTimer);
+    statisticsTimer = 0;
+  }
+  if (controllerUpdateTimer) {
+    IPlatform::instance().unregisterTimer(controllerUpdateTimer);
+    controllerUpdateTimer = 0;
+  }
   if (windowController)
     windowController->closePlugView();
   windowController.reset();
+  gComponentHandler.connect({}, nullptr);
+#if MIN_VST_HOST_WITH_AUDIO
+  audioGraph.reset();
+  audioChain.reset();
+  audioClient.reset();
+  extraPlugins.clear();
+#endif
   plugProvider.reset();
   module.reset();
   PluginContextFactory::instance().setPluginContext(nullptr);
@@ -34,7 +34,17 @@
 #include "public.sdk/source/vst/hosting/plugprovider.h"
 #include "public.sdk/source/vst/utility/optional.h"
 #include "source/platform/iapplication.h"
+#include "source/pluginscanner.h"
+#include "source/scancache.h"
 #include "source/platform/iwindow.h"
+#include "source/toml11/toml.hpp"
+
+#if MIN_VST_HOST_WITH_AUDIO
+#include "source/batchrender.h"
+#include "source/media/audioclient.h"
+#include "source/media/pluginchain.h"
+#include "source/media/processgraph.h"
+#endif
 
 //------------------------------------------------------------------------
 namespace Steinberg {
@@ -54,16 +64,54 @@ private:
   enum OpenFlags {
     kSetComponentHandler = 1 << 0,
     kSecondWindow = 1 << 1,
+    kStartAudio = 1 << 2,
+    kDoublePrecision = 1 << 3,
   };
   void openEditor(const std::string &path, VST3::Optional<VST3::UID> effectID,
                   uint32 flags);
   void createViewAndShow(IEditController *controller);
+  void loadPlugin(const std::string &path,
+                  const VST3::Optional<VST3::UID> &effectID,
+                  VST3::Hosting::Module::Ptr &pluginModule,
+                  IPtr<PlugProvider> &provider);
+  void startAudioProcessing(const std::string &name, uint32 flags);
+#if MIN_VST_HOST_WITH_AUDIO
+  void renderJobFile(const std::string &path, int32 numWorkers);
+  AudioClientPtr createExtraPlugin(const std::string &path,
+                                   const AudioClientOptions &options);
+  AudioClientPtr startAudioGraph(const std::string &name,
+                                 IComponent *component,
+                                 IEditController *editController,
+                                 const AudioClientOptions &options);
+#endif
+  void scanPluginDirectories(const std::vector<std::string> &directories,
+                             const PluginScanOptions &options);
+  void startStatisticsReport(uint64 intervalMs);
+  void reportStatistics();
 
   VST3::Hosting::Module::Ptr module{nullptr};
   IPtr<PlugProvider> plugProvider{nullptr};
   Vst::HostApplication pluginContext;
   WindowPtr window;
   std::shared_ptr<WindowController> windowController;
+#if MIN_VST_HOST_WITH_AUDIO
+  //! --chain and --parallel plug-ins, processed without editor.
+  struct ExtraPlugin {
+    VST3::Hosting::Module::Ptr module;
+    IPtr<PlugProvider> plugProvider;
+  };
+  AudioClientPtr audioClient;
+  PluginChainPtr audioChain;
+  ProcessGraphPtr audioGraph;
+  std::vector<ExtraPlugin> extraPlugins;
+#endif
+  std::vector<std::string> chainPaths;
+  std::vector<std::string> parallelPaths;
+  uint64_t statisticsTimer{0};
+  uint64_t controllerUpdateTimer{0};
+  ScanCache scanCache;
+  //! Audio engine options from the command line and config file.
+  toml::value audioSettings{toml::table{}};
 };
 
 //------------------------------------------------------------------------
@@ -29,14 +29,18 @@
 
 #include "audioclient.h"
 
-#include "miditovst.h"
+#include "rtguard.h"
+#include "sampleconvert.h"
 #include "pluginterfaces/vst/ivsteditcontroller.h"
 #include "pluginterfaces/vst/ivstmidicontrollers.h"
+#include "pluginterfaces/vst/ivstunits.h"
 #include "public.sdk/source/vst/hosting/eventlist.h"
 #include "public.sdk/source/vst/hosting/parameterchanges.h"
 #include "public.sdk/source/vst/utility/stringconvert.h"
 
+#include <algorithm>
 #include <cassert>
+#include <thread>
 
 //------------------------------------------------------------------------
 namespace Steinberg {
@@ -44,22 +48,17 @@ namespace Vst {
 
 //------------------------------------------------------------------------
 // From Vst2Wrapper
-static MidiCCMapping initMidiCtrlerAssignment(IComponent *component,
-                                              IMidiMapping *midiMapping) {
-  MidiCCMapping midiCCMapping{};
+static void initMidiCtrlerAssignment(IComponent *component,
+                                     IMidiMapping *midiMapping,
+                                     MidiCCMapping &midiCCMapping) {
+  midiCCMapping.clear();
 
   if (!midiMapping || !component)
-    return midiCCMapping;
+    return;
 
   int32 busses = std::min<int32>(component->getBusCount(kEvent, kInput),
                                  kMaxMidiMappingBusses);
 
-  if (midiCCMapping[0][0].empty()) {
-    for (int32 b = 0; b < busses; b++)
-      for (int32 i = 0; i < kMaxMidiChannels; i++)
-        midiCCMapping[b][i].resize(Vst::kCountCtrlNumber);
-  }
-
   ParamID paramID;
   for (int32 b = 0; b < busses; b++) {
     for (int16 ch = 0; ch < kMaxMidiChannels; ch++) {
@@ -68,55 +67,77 @@ static MidiCCMapping initMidiCtrlerAssignment(IComponent *component,
         if (midiMapping->getMidiControllerAssignment(b, ch, (CtrlNumber)i,
                                                      paramID) == kResultTrue) {
           // TODO check if tag is associated to a parameter
-          midiCCMapping[b][ch][i] = paramID;
-        } else
-          midiCCMapping[b][ch][i] = kNoParamId;
+          midiCCMapping.set(b, ch, i, paramID);
+        }
       }
     }
   }
-  return midiCCMapping;
-}
-
-//------------------------------------------------------------------------
-static void assignBusBuffers(const IAudioClient::Buffers &buffers,
-                             HostProcessData &processData,
-                             bool unassign = false) {
-  // Set outputs
-  auto bufferIndex = 0;
-  for (auto busIndex = 0; busIndex < processData.numOutputs; busIndex++) {
-    auto channelCount = processData.outputs[busIndex].numChannels;
-    for (auto chanIndex = 0; chanIndex < channelCount; chanIndex++) {
-      if (bufferIndex < buffers.numOutputs) {
-        processData.setChannelBuffer(
-            BusDirections::kOutput, busIndex, chanIndex,
-            unassign ? nullptr : buffers.outputs[bufferIndex]);
-        bufferIndex++;
-      }
+}
+
+//------------------------------------------------------------------------
+//! Program change parameter of the unit each event input channel plays
+//! (IUnitInfo::getUnitByBus), or of the closest parent unit having one.
+static void initMidiProgramAssignment(IComponent *component,
+                                      IEditController *controller,
+                                      MidiInputChannels &channels) {
+  for (auto &channel : channels)
+    channel.program = {};
+
+  FUnknownPtr<IUnitInfo> unitInfo(controller);
+  if (!unitInfo || !component)
+    return;
+
+  std::unordered_map<UnitID, MidiProgramTarget> unitPrograms;
+  for (int32 i = 0, count = controller->getParameterCount(); i < count; ++i) {
+    ParameterInfo info{};
+    if (controller->getParameterInfo(i, info) == kResultOk &&
+        (info.flags & ParameterInfo::kIsProgramChange))
+      unitPrograms[info.unitId] = {info.id, info.stepCount + 1};
+  }
+  if (unitPrograms.empty())
+    return;
+
+  std::unordered_map<UnitID, UnitInfo> units;
+  for (int32 i = 0, count = unitInfo->getUnitCount(); i < count; ++i) {
+    UnitInfo info{};
+    if (unitInfo->getUnitInfo(i, info) == kResultOk)
+      units[info.id] = info;
+  }
+  // The unit's program list has the authoritative program count.
+  for (int32 i = 0, count = unitInfo->getProgramListCount(); i < count; ++i) {
+    ProgramListInfo info{};
+    if (unitInfo->getProgramListInfo(i, info) != kResultOk)
+      continue;
+    for (const auto &unit : units) {
+      auto program = unitPrograms.find(unit.first);
+      if (unit.second.programListId == info.id && program != unitPrograms.end())
+        program->second.programCount = info.programCount;
     }
   }
 
-  // Set inputs
-  bufferIndex = 0;
-  for (auto busIndex = 0; busIndex < processData.numInputs; busIndex++) {
-    auto channelCount = processData.inputs[busIndex].numChannels;
-    for (auto chanIndex = 0; chanIndex < channelCount; chanIndex++) {
-      if (bufferIndex < buffers.numInputs) {
-        processData.setChannelBuffer(BusDirections::kInput, busIndex, chanIndex,
-                                     unassign ? nullptr
-                                              : buffers.inputs[bufferIndex]);
-
-        bufferIndex++;
+  int32 busses = std::min<int32>(component->getBusCount(kEvent, kInput),
+                                 kMaxMidiMappingBusses);
+  for (int32 b = 0; b < busses; b++) {
+    for (int32 ch = 0; ch < kMaxMidiChannels; ch++) {
+      UnitID unitId = kRootUnitId;
+      if (unitInfo->getUnitByBus(kEvent, kInput, b, ch, unitId) != kResultOk)
+        unitId = kRootUnitId;
+      // bounded, a broken unit tree must not hang the host
+      for (size_t depth = 0; depth <= units.size(); ++depth) {
+        auto program = unitPrograms.find(unitId);
+        if (program != unitPrograms.end()) {
+          channels[b * kMaxMidiChannels + ch].program = program->second;
+          break;
+        }
+        auto unit = units.find(unitId);
+        if (unit == units.end() || unit->second.parentUnitId == kNoParentUnitId)
+          break;
+        unitId = unit->second.parentUnitId;
       }
     }
   }
 }
 
-//------------------------------------------------------------------------
-static void unassignBusBuffers(const IAudioClient::Buffers &buffers,
-                               HostProcessData &processData) {
-  assignBusBuffers(buffers, processData, true);
-}
-
 //------------------------------------------------------------------------
 //  Vst3Processor
 //------------------------------------------------------------------------
@@ -127,9 +148,23 @@ AudioClient::~AudioClient() { terminate(); }
 
 //------------------------------------------------------------------------
 AudioClientPtr AudioClient::create(const Name &name, IComponent *component,
-                                   IMidiMapping *midiMapping) {
+                                   IEditController *controller,
+                                   const AudioClientOptions &options) {
+  auto server = createMediaServer(name, options.realtime);
+  if (!server)
+    return nullptr;
+  return create(name, component, controller, server, options);
+}
+
+//------------------------------------------------------------------------
+AudioClientPtr AudioClient::create(const Name &name, IComponent *component,
+                                   IEditController *controller,
+                                   const IMediaServerPtr &mediaServer,
+                                   const AudioClientOptions &options) {
   auto newProcessor = std::make_shared<AudioClient>();
-  newProcessor->initialize(name, component, midiMapping);
+  if (!newProcessor->initialize(name, component, controller, mediaServer,
+                                options))
+    return nullptr;
   return newProcessor;
 }
 
@@ -140,40 +175,76 @@ void AudioClient::initProcessContext() {
 }
 
 //------------------------------------------------------------------------
-void AudioClient::createLocalMediaServer(const Name &name) {
-  mediaServer = createMediaServer(name);
-  mediaServer->registerAudioClient(this);
-  mediaServer->registerMidiClient(this);
+bool AudioClient::attachMediaServer(const IMediaServerPtr &server) {
+  mediaServer = server;
+  if (!mediaServer)
+    return true;
+  if (!mediaServer->registerAudioClient(this))
+    return false;
+  return mediaServer->registerMidiClient(this);
 }
 
 //------------------------------------------------------------------------
-bool AudioClient::initialize(const Name &name, IComponent *_component,
-                             IMidiMapping *midiMapping) {
+bool AudioClient::initialize(const Name &_name, IComponent *_component,
+                             IEditController *controller,
+                             const IMediaServerPtr &server,
+                             const AudioClientOptions &options) {
+  name = _name;
   component = _component;
+  editController = controller;
   if (!component)
     return false;
 
-  initProcessData();
+  //! Resolved once, process() runs on the realtime thread.
+  processor = component;
+  if (!processor)
+    return false;
 
-  paramTransferrer.setMaxParameters(1000);
+  subBlockSize = std::max<int32>(options.subBlockSize, 0);
+  processMode = options.processMode;
+  countPageFaults = options.countPageFaults;
+  if (options.symbolicSampleSize == kSample64 &&
+      processor->canProcessSampleSize(kSample64) == kResultTrue)
+    symbolicSampleSize = kSample64;
 
-  if (midiMapping)
-    midiCCMapping = initMidiCtrlerAssignment(component, midiMapping);
+  initProcessData();
 
-  createLocalMediaServer(name);
-  return true;
+  // Preallocated here, so neither queue nor parameter changes allocate on
+  // the realtime thread.
+  auto maxParameters =
+      std::max<int32>(controller ? controller->getParameterCount() : 0, 1);
+  parameterQueue.reset(static_cast<size_t>(maxParameters) *
+                       std::max<int32>(options.parameterQueueMultiplier, 1));
+  inputParameterChanges.setMaxParameters(maxParameters);
+  outputParameterChanges.setMaxParameters(maxParameters);
+  outputParameterQueue.reset(parameterQueue.capacity());
+  if (subBlockSize > 0)
+    subBlockParameterChanges.setMaxParameters(maxParameters);
+  eventQueue.reset(std::max<int32>(options.eventQueueSize, 0));
+  auto maxEvents = std::max<int32>(options.maxEventsPerBlock, 1);
+  eventList.setMaxSize(maxEvents);
+  if (subBlockSize > 0)
+    subBlockEventList.setMaxSize(maxEvents);
+
+  sysExBuffer.resize(std::max<int32>(options.sysExBufferSize, 0));
+
+  FUnknownPtr<IMidiMapping> midiMapping(controller);
+  initMidiCtrlerAssignment(component, midiMapping, midiCCMapping);
+  initMidiProgramAssignment(component, controller, midiInputChannels);
+
+  return attachMediaServer(server);
 }
 
 //------------------------------------------------------------------------
 void AudioClient::terminate() {
   mediaServer = nullptr;
 
-  FUnknownPtr<IAudioProcessor> processor = component;
   if (!processor)
     return;
 
   processor->setProcessing(false);
   component->setActive(false);
+  processor = nullptr;
 }
 
 //------------------------------------------------------------------------
@@ -182,7 +253,9 @@ void AudioClient::initProcessData() {
 
   processData.inputEvents = &eventList;
   processData.inputParameterChanges = &inputParameterChanges;
+  processData.outputParameterChanges = &outputParameterChanges;
   processData.processContext = &processContext;
+  processData.processMode = processMode;
 
   initProcessContext();
 }
@@ -252,35 +325,359 @@ IAudioClient::IOSetup AudioClient::getIOSetup() const {
 //------------------------------------------------------------------------
 void AudioClient::preprocess(Buffers &buffers, int64_t continousFrames) {
   processData.numSamples = buffers.numSamples;
+  if (buffers.processContext) {
+    processContext = *buffers.processContext;
+    processContext.sampleRate = sampleRate;
+  }
   processContext.continousTimeSamples = continousFrames;
-  assignBusBuffers(buffers, processData);
-  paramTransferrer.transferChangesTo(inputParameterChanges);
+  assignBusBuffers(buffers);
+  drainParameterQueue();
+  drainEventQueue();
+}
+
+//------------------------------------------------------------------------
+void AudioClient::drainParameterQueue() {
+  QueuedParameter change;
+  while (parameterQueue.pop(change)) {
+    int32 index = 0;
+    auto *queue = inputParameterChanges.addParameterData(change.id, index);
+    if (queue)
+      queue->addPoint(change.sampleOffset, change.value, index);
+  }
+}
+
+//------------------------------------------------------------------------
+void AudioClient::drainEventQueue() {
+  // Servers deliver their events before process(), so the first onEvent()
+  // of a period drains the queue to keep the event list sorted.
+  if (eventQueueDrained)
+    return;
+  eventQueueDrained = true;
+
+  QueuedEvent queued;
+  while (eventQueue.pop(queued)) {
+    queued.event.timestamp = 0;
+    onEvent(queued.event, queued.port);
+  }
+}
+
+//------------------------------------------------------------------------
+void AudioClient::updateBusRouting() {
+  updateSubBlockSlots();
+
+  int32 numChannels = 0;
+  for (int32 i = 0; i < processData.numInputs; ++i)
+    numChannels += processData.inputs[i].numChannels;
+  for (int32 i = 0; i < processData.numOutputs; ++i)
+    numChannels += processData.outputs[i].numChannels;
+
+  inputRoutes.clear();
+  outputRoutes.clear();
+  inputBuffers64.clear();
+  outputBuffers64.clear();
+
+  if (symbolicSampleSize == kSample64) {
+    //! The plug-in always processes the scratch memory, server buffers are
+    //! converted into and out of it.
+    scratchBuffers64.assign(static_cast<size_t>(numChannels) * blockSize, 0.);
+    auto *scratch = scratchBuffers64.data();
+    auto route = [&](AudioBusBuffers *busses, int32 numBusses,
+                     ChannelBuffers64 &channelBuffers) {
+      for (int32 busIndex = 0; busIndex < numBusses; ++busIndex) {
+        auto &bus = busses[busIndex];
+        for (int32 chanIndex = 0; chanIndex < bus.numChannels; ++chanIndex) {
+          bus.channelBuffers64[chanIndex] = scratch;
+          channelBuffers.push_back(scratch);
+          scratch += blockSize;
+        }
+      }
+    };
+    route(processData.inputs, processData.numInputs, inputBuffers64);
+    route(processData.outputs, processData.numOutputs, outputBuffers64);
+    return;
+  }
+
+  //! Channels without a server buffer keep pointing to silent scratch
+  //! memory, so only the routed slots have to be written per block.
+  scratchBuffers.assign(static_cast<size_t>(numChannels) * blockSize, 0.f);
+  auto *scratch = scratchBuffers.data();
+  auto route = [&](AudioBusBuffers *busses, int32 numBusses,
+                   ChannelRoutes &routes) {
+    for (int32 busIndex = 0; busIndex < numBusses; ++busIndex) {
+      auto &bus = busses[busIndex];
+      for (int32 chanIndex = 0; chanIndex < bus.numChannels; ++chanIndex) {
+        bus.channelBuffers32[chanIndex] = scratch;
+        scratch += blockSize;
+        routes.push_back(&bus.channelBuffers32[chanIndex]);
+      }
+    }
+  };
+  route(processData.inputs, processData.numInputs, inputRoutes);
+  route(processData.outputs, processData.numOutputs, outputRoutes);
 }
 
+//------------------------------------------------------------------------
+void AudioClient::updateSubBlockSlots() {
+  channelSlots.clear();
+  auto collect = [&](AudioBusBuffers *busses, int32 numBusses) {
+    for (int32 busIndex = 0; busIndex < numBusses; ++busIndex) {
+      auto &bus = busses[busIndex];
+      auto slots = reinterpret_cast<void **>(bus.channelBuffers32);
+      for (int32 chanIndex = 0; chanIndex < bus.numChannels; ++chanIndex)
+        channelSlots.push_back(slots + chanIndex);
+    }
+  };
+  collect(processData.inputs, processData.numInputs);
+  collect(processData.outputs, processData.numOutputs);
+  periodBuffers.resize(channelSlots.size());
+}
+
+//------------------------------------------------------------------------
+void AudioClient::assignBusBuffers(const Buffers &buffers) {
+  if (symbolicSampleSize == kSample64) {
+    auto numInputs = std::min(buffers.numInputs,
+                              static_cast<int32>(inputBuffers64.size()));
+    for (int32 i = 0; i < numInputs; ++i)
+      convertToSample64(buffers.inputs[i], inputBuffers64[i],
+                        buffers.numSamples);
+    return;
+  }
+
+  auto numInputs =
+      std::min(buffers.numInputs, static_cast<int32>(inputRoutes.size()));
+  for (int32 i = 0; i < numInputs; ++i)
+    *inputRoutes[i] = buffers.inputs[i];
+
+  auto numOutputs =
+      std::min(buffers.numOutputs, static_cast<int32>(outputRoutes.size()));
+  for (int32 i = 0; i < numOutputs; ++i)
+    *outputRoutes[i] = buffers.outputs[i];
+}
+
+//------------------------------------------------------------------------
+//! The client whose process() runs on this thread, if any.
+static thread_local const AudioClient *processingClient = nullptr;
+
 //------------------------------------------------------------------------
 bool AudioClient::process(Buffers &buffers, int64_t continousFrames) {
-  FUnknownPtr<IAudioProcessor> processor = component;
+  RTGuard::Scope rtGuard(rtCounters);
+
+  //! Handshake with restart(), which waits until no process() call is in
+  //! flight before it touches the processor setup. The thread also notes
+  //! the client it processes, so a restart from inside process() can be
+  //! deferred instead of waiting for itself.
+  struct InProcessGuard {
+    std::atomic<bool> &flag;
+    const AudioClient *previousClient;
+    InProcessGuard(std::atomic<bool> &value, const AudioClient *client)
+        : flag(value), previousClient(processingClient) {
+      flag.store(true);
+      processingClient = client;
+    }
+    ~InProcessGuard() {
+      processingClient = previousClient;
+      flag.store(false, std::memory_order_release);
+    }
+  } inProcessGuard(inProcess, this);
+  if (suspended.load()) {
+    for (int32 i = 0; i < buffers.numOutputs; ++i)
+      std::fill_n(buffers.outputs[i], buffers.numSamples, 0.f);
+    eventList.clear();
+    sysExBufferUsed = 0;
+    inputParameterChanges.clearQueue();
+    eventQueueDrained = false;
+    return true;
+  }
+
   if (!processor || !isProcessing)
     return false;
 
+  auto startPageFaults = countPageFaults ? currentThreadPageFaults() : 0;
+  auto startTime = ProcessStatistics::Clock::now();
+
   preprocess(buffers, continousFrames);
 
-  if (processor->process(processData) != kResultOk)
-    return false;
+  auto result = subBlockSize > 0 && buffers.numSamples > subBlockSize
+                    ? processSubBlocks(buffers.numSamples)
+                    : processor->process(processData) == kResultOk;
 
   postprocess(buffers);
+  if (!result)
+    return false;
+
+  auto duration = ProcessStatistics::Clock::now() - startTime;
+  auto budget = static_cast<int64>(buffers.numSamples * 1e9 / sampleRate);
+  processStatistics.record(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+      budget);
+  processStatistics.recordRealtimeViolations(
+      rtCounters.allocations, rtCounters.deallocations, rtCounters.locks);
+  if (countPageFaults)
+    processStatistics.recordPageFaults(
+        static_cast<uint64>(currentThreadPageFaults() - startPageFaults));
 
   return true;
 }
+
+//------------------------------------------------------------------------
+bool AudioClient::processSubBlocks(int32 numSamples) {
+  auto sampleBytes = symbolicSampleSize == kSample64 ? sizeof(Sample64)
+                                                     : sizeof(Sample32);
+  for (size_t i = 0; i < channelSlots.size(); ++i)
+    periodBuffers[i] = *channelSlots[i];
+
+  auto periodContext = processContext;
+  processData.inputParameterChanges = &subBlockParameterChanges;
+  processData.inputEvents = &subBlockEventList;
+
+  bool result = true;
+  for (int32 offset = 0; offset < numSamples && result;
+       offset += subBlockSize) {
+    auto count = std::min(subBlockSize, numSamples - offset);
+    for (size_t i = 0; i < channelSlots.size(); ++i)
+      *channelSlots[i] = static_cast<uint8 *>(periodBuffers[i]) +
+                         static_cast<size_t>(offset) * sampleBytes;
+
+    sliceInputChanges(offset, offset + count);
+    processData.numSamples = count;
+    result = processor->process(processData) == kResultOk;
+    drainOutputParameterChanges();
+
+    subBlockParameterChanges.clearQueue();
+    subBlockEventList.clear();
+    advanceProcessContext(count);
+  }
+
+  for (size_t i = 0; i < channelSlots.size(); ++i)
+    *channelSlots[i] = periodBuffers[i];
+  processData.numSamples = numSamples;
+  processData.inputParameterChanges = &inputParameterChanges;
+  processData.inputEvents = &eventList;
+  processContext = periodContext;
+  return result;
+}
+
+//------------------------------------------------------------------------
+void AudioClient::sliceInputChanges(int32 begin, int32 end) {
+  for (int32 i = 0, count = inputParameterChanges.getParameterCount();
+       i < count; ++i) {
+    auto *queue = inputParameterChanges.getParameterData(i);
+    if (!queue)
+      continue;
+
+    IParamValueQueue *subBlockQueue = nullptr;
+    for (int32 p = 0, points = queue->getPointCount(); p < points; ++p) {
+      int32 sampleOffset;
+      ParamValue value;
+      if (queue->getPoint(p, sampleOffset, value) != kResultOk ||
+          sampleOffset < begin || sampleOffset >= end)
+        continue;
+
+      int32 index;
+      if (!subBlockQueue)
+        subBlockQueue = subBlockParameterChanges.addParameterData(
+            queue->getParameterId(), index);
+      if (subBlockQueue)
+        subBlockQueue->addPoint(sampleOffset - begin, value, index);
+    }
+  }
+
+  for (int32 i = 0, count = eventList.getEventCount(); i < count; ++i) {
+    Vst::Event event;
+    if (eventList.getEvent(i, event) != kResultOk ||
+        event.sampleOffset < begin || event.sampleOffset >= end)
+      continue;
+
+    event.sampleOffset -= begin;
+    subBlockEventList.addEvent(event);
+  }
+}
+
+//------------------------------------------------------------------------
+void AudioClient::advanceProcessContext(int32 numSamples) {
+  processContext.continousTimeSamples += numSamples;
+  if ((processContext.state & ProcessContext::kPlaying) == 0)
+    return;
+
+  processContext.projectTimeSamples += numSamples;
+  if (processContext.state & ProcessContext::kProjectTimeMusicValid &&
+      processContext.state & ProcessContext::kTempoValid)
+    processContext.projectTimeMusic +=
+        numSamples * processContext.tempo / (60. * sampleRate);
+
+  // A sub-block may cross a bar line, move the bar start along with it.
+  if ((processContext.state & ProcessContext::kBarPositionValid) == 0)
+    return;
+  if ((processContext.state & ProcessContext::kTimeSigValid) == 0 ||
+      processContext.timeSigNumerator <= 0 ||
+      processContext.timeSigDenominator <= 0) {
+    processContext.state &= ~ProcessContext::kBarPositionValid;
+    return;
+  }
+  auto barLength = processContext.timeSigNumerator * 4. /
+                   processContext.timeSigDenominator;
+  while (processContext.projectTimeMusic >=
+         processContext.barPositionMusic + barLength)
+    processContext.barPositionMusic += barLength;
+}
+
 //------------------------------------------------------------------------
 void AudioClient::postprocess(Buffers &buffers) {
+  if (symbolicSampleSize == kSample64) {
+    auto numOutputs = std::min(buffers.numOutputs,
+                               static_cast<int32>(outputBuffers64.size()));
+    for (int32 i = 0; i < numOutputs; ++i)
+      convertToSample32(outputBuffers64[i], buffers.outputs[i],
+                        buffers.numSamples);
+  }
+
+  drainOutputParameterChanges();
   eventList.clear();
+  sysExBufferUsed = 0;
   inputParameterChanges.clearQueue();
-  unassignBusBuffers(buffers, processData);
+  eventQueueDrained = false;
+}
+
+//------------------------------------------------------------------------
+void AudioClient::drainOutputParameterChanges() {
+  for (int32 i = 0, count = outputParameterChanges.getParameterCount();
+       i < count; ++i) {
+    auto *queue = outputParameterChanges.getParameterData(i);
+    if (!queue || queue->getPointCount() <= 0)
+      continue;
+
+    int32 sampleOffset;
+    ParamValue value;
+    if (queue->getPoint(queue->getPointCount() - 1, sampleOffset, value) !=
+        kResultOk)
+      continue;
+    if (!outputParameterQueue.push(
+            {queue->getParameterId(), value, sampleOffset}))
+      processStatistics.countDroppedParameterChange();
+  }
+  outputParameterChanges.clearQueue();
+}
+
+//------------------------------------------------------------------------
+void AudioClient::updateController() {
+  if (auto flags = pendingRestartFlags.exchange(0))
+    restart(flags);
+
+  if (!editController)
+    return;
+
+  QueuedParameter change;
+  while (outputParameterQueue.pop(change))
+    outputValues[change.id] = change.value;
+
+  for (const auto &entry : outputValues)
+    editController->setParamNormalized(entry.first, entry.second);
+  outputValues.clear();
 }
 
 //------------------------------------------------------------------------
 bool AudioClient::setSamplerate(SampleRate value) {
+  std::lock_guard<std::mutex> lock(setupMutex);
   if (sampleRate == value)
     return true;
 
@@ -294,6 +691,7 @@ bool AudioClient::setSamplerate(SampleRate value) {
 
 //------------------------------------------------------------------------
 bool AudioClient::setBlockSize(int32 value) {
+  std::lock_guard<std::mutex> lock(setupMutex);
   if (blockSize == value)
     return true;
 
@@ -301,17 +699,43 @@ bool AudioClient::setBlockSize(int32 value) {
   if (sampleRate == 0)
     return true;
 
-  processData.prepare(*component, blockSize, kSample32);
   return updateProcessSetup();
 }
 
+//------------------------------------------------------------------------
+bool AudioClient::restart(int32 flags) {
+  flags &= RestartFlags::kLatencyChanged | RestartFlags::kIoChanged;
+  if (flags == 0)
+    return true;
+  // waiting for process() to return would deadlock, updateController()
+  // picks the flags up on the UI thread
+  if (processingClient == this) {
+    pendingRestartFlags.fetch_or(flags);
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(setupMutex);
+  if (!processor || sampleRate == 0 || blockSize == 0)
+    return true;
+
+  suspended.store(true);
+  while (inProcess.load())
+    std::this_thread::yield();
+
+  // a processor that failed to set up stays suspended
+  if (!updateProcessSetup())
+    return false;
+  suspended.store(false, std::memory_order_release);
+  return true;
+}
+
 //------------------------------------------------------------------------
 bool AudioClient::updateProcessSetup() {
-  FUnknownPtr<IAudioProcessor> processor = component;
   if (!processor)
     return false;
 
   if (isProcessing) {
+    isProcessing = false;
     if (processor->setProcessing(false) != kResultOk)
       return false;
 
@@ -319,7 +743,17 @@ bool AudioClient::updateProcessSetup() {
       return false;
   }
 
-  ProcessSetup setup{kRealtime, kSample32, blockSize, sampleRate};
+  //! Servers may announce the sample rate after the block size, so the
+  //! buffers are (re)prepared whenever the setup changes. The channel
+  //! buffers themselves are owned by updateBusRouting.
+  processData.prepare(*component, 0, symbolicSampleSize);
+  updateBusRouting();
+
+  auto maxSamplesPerBlock = blockSize;
+  if (subBlockSize > 0)
+    maxSamplesPerBlock = std::min(subBlockSize, blockSize);
+  ProcessSetup setup{processMode, symbolicSampleSize, maxSamplesPerBlock,
+                     sampleRate};
 
   if (processor->setupProcessing(setup) != kResultOk)
     return false;
@@ -337,57 +771,140 @@ return false;*/
 }
 
 //------------------------------------------------------------------------
-bool AudioClient::isPortInRange(int32 port, int32 channel) const {
-  return port < kMaxMidiMappingBusses && !midiCCMapping[port][channel].empty();
+//! Reset All Controllers as recommended by MIDI RP-015.
+static const struct {
+  int32 controller;
+  ParamValue value;
+} kControllerResets[] = {
+    {kCtrlModWheel, 0.},       {kCtrlExpression, 1.},
+    {kCtrlSustainOnOff, 0.},   {kCtrlPortaOnOff, 0.},
+    {kCtrlSustenutoOnOff, 0.}, {kCtrlSoftPedalOnOff, 0.},
+    {kAfterTouch, 0.},         {kPitchBend, 0x2000 * kMidi14BitScaler},
+};
+
+//------------------------------------------------------------------------
+MidiInputChannel *AudioClient::findMidiInputChannel(int32 port,
+                                                    int32 channel) {
+  if (static_cast<uint32>(port) >= kMaxMidiMappingBusses ||
+      static_cast<uint32>(channel) >= kMaxMidiChannels)
+    return nullptr;
+  return &midiInputChannels[port * kMaxMidiChannels + channel];
+}
+
+//------------------------------------------------------------------------
+void AudioClient::addVstEvent(Vst::Event &event, int32 port,
+                              int64_t timestamp) {
+  event.busIndex = port;
+  event.sampleOffset = static_cast<int32>(timestamp);
+  if (eventList.addEvent(event) != kResultOk)
+    processStatistics.countDroppedEvent();
 }
 
 //------------------------------------------------------------------------
 bool AudioClient::processVstEvent(const IMidiClient::Event &event, int32 port) {
+  if (event.type == kSysExStatus)
+    return processSysEx(event, port);
+
   auto vstEvent =
       midiToEvent(event.type, event.channel, event.data0, event.data1);
-  if (vstEvent) {
-    vstEvent->busIndex = port;
-    if (eventList.addEvent(*vstEvent) != kResultOk) {
-      assert(false && "Event was not added to EventList!");
-    }
+  if (!vstEvent)
+    return false;
 
+  addVstEvent(*vstEvent, port, event.timestamp);
+  if (auto *midiChannel = findMidiInputChannel(port, event.channel)) {
+    if (event.type == kNoteOn)
+      midiChannel->state.noteOn(event.data0);
+    else if (event.type == kNoteOff)
+      midiChannel->state.noteOff(event.data0);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool AudioClient::processSysEx(const IMidiClient::Event &event, int32 port) {
+  // The server's bytes are gone after onEvent, the processor gets a copy
+  // with the F0 status restored.
+  auto size = static_cast<size_t>(event.sysExSize) + 1;
+  if (!event.sysExData || sysExBuffer.size() - sysExBufferUsed < size) {
+    processStatistics.countDroppedEvent();
     return true;
   }
 
-  return false;
+  auto *bytes = sysExBuffer.data() + sysExBufferUsed;
+  bytes[0] = kSysExStatus;
+  std::copy_n(event.sysExData, event.sysExSize, bytes + 1);
+  sysExBufferUsed += size;
+
+  auto vstEvent = sysExToEvent(bytes, static_cast<uint32>(size));
+  addVstEvent(vstEvent, port, event.timestamp);
+  return true;
+}
+
+//------------------------------------------------------------------------
+void AudioClient::addParameterPoint(ParamID id, ParamValue value,
+                                    int32 sampleOffset) {
+  int32 index = 0;
+  IParamValueQueue *queue = inputParameterChanges.addParameterData(id, index);
+  if (queue) {
+    if (queue->addPoint(sampleOffset, value, index) != kResultOk) {
+      assert(false && "Parameter point was not added to ParamValueQueue!");
+    }
+  }
 }
 
 //------------------------------------------------------------------------
 bool AudioClient::processParamChange(const IMidiClient::Event &event,
                                      int32 port) {
-  auto paramMapping = [port, this](int32 channel, MidiData data1) -> ParamID {
-    if (!isPortInRange(port, channel))
-      return kNoParamId;
+  auto *midiChannel = findMidiInputChannel(port, event.channel);
+  MidiChannelState unmappedState;
+  auto paramChange = midiToParameter(
+      event.type, event.channel, event.data0, event.data1,
+      midiChannel ? midiChannel->state : unmappedState,
+      [&](int32 channel, int32 controller) {
+        return midiCCMapping.get(port, channel, controller);
+      },
+      [&](int32) {
+        return midiChannel ? midiChannel->program : MidiProgramTarget{};
+      });
+  if (paramChange) {
+    addParameterPoint((*paramChange).first, (*paramChange).second,
+                      static_cast<int32>(event.timestamp));
+    return true;
+  }
 
-    return midiCCMapping[port][channel][data1];
-  };
+  return false;
+}
 
-  auto paramChange = midiToParameter(event.type, event.channel, event.data0,
-                                     event.data1, paramMapping);
-  if (paramChange) {
-    int32 index = 0;
-    IParamValueQueue *queue =
-        inputParameterChanges.addParameterData((*paramChange).first, index);
-    if (queue) {
-      if (queue->addPoint(static_cast<int32>(event.timestamp),
-                          (*paramChange).second, index) != kResultOk) {
-        assert(false && "Parameter point was not added to ParamValueQueue!");
-      }
-    }
+//------------------------------------------------------------------------
+bool AudioClient::processChannelMode(const IMidiClient::Event &event,
+                                     int32 port) {
+  auto *midiChannel = findMidiInputChannel(port, event.channel);
+  if (event.type != kController || event.data0 < kCtrlAllSoundsOff ||
+      event.data0 == kCtrlLocalCtrlOnOff || !midiChannel)
+    return false;
 
+  if (event.data0 == kCtrlResetAllCtrlers) {
+    midiChannel->state.resetControllers();
+    for (const auto &reset : kControllerResets) {
+      auto id = midiCCMapping.get(port, event.channel, reset.controller);
+      if (id != kNoParamId)
+        addParameterPoint(id, reset.value, static_cast<int32>(event.timestamp));
+    }
     return true;
   }
 
-  return false;
+  // All sound off, all notes off and the mode changes implying it.
+  midiChannel->state.releaseNotes([&](MidiData pitch) {
+    auto noteOff = midiToEvent(kNoteOff, event.channel, pitch, 0);
+    addVstEvent(*noteOff, port, event.timestamp);
+  });
+  return true;
 }
 
 //------------------------------------------------------------------------
 bool AudioClient::onEvent(const IMidiClient::Event &event, int32_t port) {
+  drainEventQueue();
+
   // Try to create Event first.
   if (processVstEvent(event, port))
     return true;
@@ -396,15 +913,27 @@ bool AudioClient::onEvent(const IMidiClient::Event &event, int32_t port) {
   if (processParamChange(event, port))
     return true;
 
-  // TODO: Something else???
-
+  // Channel mode messages the plug-in does not map to parameters.
+  processChannelMode(event, port);
   return true;
 }
 
+//------------------------------------------------------------------------
+bool AudioClient::postEvent(const Event &event, int32_t port) {
+  if (event.type == kSysExStatus)
+    return false;
+  if (eventQueue.push({event, port}))
+    return true;
+
+  processStatistics.countDroppedEvent();
+  return false;
+}
+
 //------------------------------------------------------------------------
 void AudioClient::setParameter(ParamID id, ParamValue value,
                                int32 sampleOffset) {
-  paramTransferrer.addChange(id, value, sampleOffset);
+  if (!parameterQueue.push({id, value, sampleOffset}))
+    processStatistics.countDroppedParameterChange();
 }
 
 //------------------------------------------------------------------------
@@ -30,26 +30,103 @@
 #pragma once
 
 #include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "pluginterfaces/vst/ivstmidicontrollers.h"
 #include "public.sdk/source/vst/hosting/eventlist.h"
 #include "public.sdk/source/vst/hosting/parameterchanges.h"
 #include "public.sdk/source/vst/hosting/processdata.h"
 #include "source/media/imediaserver.h"
 #include "source/media/iparameterclient.h"
+#include "source/media/miditovst.h"
+#include "source/media/processstatistics.h"
+#include "source/media/rtguard.h"
+#include "source/media/spscqueue.h"
 #include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 //------------------------------------------------------------------------
 namespace Steinberg {
 namespace Vst {
 
 //------------------------------------------------------------------------
-class IMidiMapping;
+class IEditController;
 class IComponent;
 
 enum { kMaxMidiMappingBusses = 4, kMaxMidiChannels = 16 };
-using Controllers = std::vector<int32>;
-using Channels = std::array<Controllers, kMaxMidiChannels>;
-using Busses = std::array<Channels, kMaxMidiMappingBusses>;
-using MidiCCMapping = Busses;
+
+//------------------------------------------------------------------------
+/** [bus][channel][controller] -> ParamID in one contiguous table.
+ *
+ *  Controllers include the kAfterTouch and kPitchBend pseudo controllers.
+ *  Lookups out of range yield kNoParamId.
+ */
+class alignas(64) MidiCCMapping {
+public:
+  MidiCCMapping() { clear(); }
+
+  void clear() { table.fill(kNoParamId); }
+
+  ParamID get(int32 bus, int32 channel, int32 controller) const {
+    if (static_cast<uint32>(bus) >= kMaxMidiMappingBusses ||
+        static_cast<uint32>(channel) >= kMaxMidiChannels ||
+        static_cast<uint32>(controller) >= kCountCtrlNumber)
+      return kNoParamId;
+    return table[index(bus, channel, controller)];
+  }
+
+  void set(int32 bus, int32 channel, int32 controller, ParamID id) {
+    table[index(bus, channel, controller)] = id;
+  }
+
+private:
+  static constexpr size_t index(int32 bus, int32 channel, int32 controller) {
+    return (static_cast<size_t>(bus) * kMaxMidiChannels + channel) *
+               kCountCtrlNumber +
+           controller;
+  }
+
+  std::array<ParamID,
+             kMaxMidiMappingBusses * kMaxMidiChannels * kCountCtrlNumber>
+      table;
+};
+
+//------------------------------------------------------------------------
+//! MIDI input state and program change parameter of one bus and channel.
+struct MidiInputChannel {
+  MidiChannelState state;
+  MidiProgramTarget program;
+};
+//! [bus][channel], for the busses MidiCCMapping covers.
+using MidiInputChannels =
+    std::array<MidiInputChannel, kMaxMidiMappingBusses * kMaxMidiChannels>;
+
+//------------------------------------------------------------------------
+struct AudioClientOptions {
+  //! kSample64 is used if the processor supports it, kSample32 otherwise.
+  int32 symbolicSampleSize = kSample32;
+  //! kOffline when the media server is not bound to the wall clock.
+  int32 processMode = kRealtime;
+  //! When > 0, server periods are split into blocks of at most this many
+  //! samples and parameter changes and events are distributed among them.
+  int32 subBlockSize = 0;
+  //! Events handed to the processor per block, further ones are dropped.
+  int32 maxEventsPerBlock = 512;
+  //! Bytes of SysEx messages handed to the processor per block, further
+  //! messages are dropped.
+  int32 sysExBufferSize = 64 * 1024;
+  //! Capacity of the queue behind AudioClient::postEvent.
+  int32 eventQueueSize = 1024;
+  //! Capacity of the queue behind AudioClient::setParameter as multiple of
+  //! the controller's parameter count, to absorb bursts.
+  int32 parameterQueueMultiplier = 4;
+  //! Count the audio thread's page faults per block (one getrusage call
+  //! before and after each block).
+  bool countPageFaults = false;
+  //! Memory locking and thread setup of the media server created by
+  //! AudioClient::create without an explicit server.
+  RealtimeOptions realtime;
+};
 
 //------------------------------------------------------------------------
 using AudioClientPtr = std::shared_ptr<class AudioClient>;
@@ -65,7 +142,12 @@ public:
   ~AudioClient() override;
 
   static AudioClientPtr create(const Name &name, IComponent *component,
-                               IMidiMapping *midiMapping);
+                               IEditController *controller,
+                               const AudioClientOptions &options = {});
+  static AudioClientPtr create(const Name &name, IComponent *component,
+                               IEditController *controller,
+                               const IMediaServerPtr &mediaServer,
+                               const AudioClientOptions &options = {});
 
   // IAudioClient
   bool process(Buffers &buffers, int64_t continousFrames) override;
@@ -81,34 +163,126 @@ public:
   void setParameter(ParamID id, ParamValue value, int32 sampleOffset) override;
 
   bool initialize(const Name &name, IComponent *component,
-                  IMidiMapping *midiMapping);
+                  IEditController *controller,
+                  const IMediaServerPtr &mediaServer,
+                  const AudioClientOptions &options);
+
+  //! Handles IComponentHandler::restartComponent: on kLatencyChanged or
+  //! kIoChanged the processor is deactivated and set up again while
+  //! processing is suspended. A call from inside process() is deferred to
+  //! the next updateController(). If the setup fails, the client stays
+  //! suspended and outputs silence.
+  bool restart(int32 flags);
+
+  //! Hands the output parameter changes of the blocks processed since the
+  //! last call to the edit controller, only the latest value per parameter,
+  //! and runs deferred restarts. To be called from the UI thread at display
+  //! rate.
+  void updateController();
+
+  //! Queues a MIDI event from a non realtime thread. It is handed to the
+  //! processor at sample offset 0 of the next block. Only one thread may
+  //! post events. Returns false if the queue is full or for SysEx, whose
+  //! bytes the queue does not own.
+  bool postEvent(const Event &event, int32_t port);
+
+  int32 getSymbolicSampleSize() const { return symbolicSampleSize; }
+
+  //! Timing of the process calls, to be polled from a non realtime thread.
+  ProcessStatistics &getProcessStatistics() { return processStatistics; }
 
   //--------------------------------------------------------------------
 private:
-  void createLocalMediaServer(const Name &name);
+  bool attachMediaServer(const IMediaServerPtr &server);
   void terminate();
-  void updateBusBuffers(Buffers &buffers, HostProcessData &processData);
+  void updateBusRouting();
+  void assignBusBuffers(const Buffers &buffers);
+  void updateSubBlockSlots();
+  bool processSubBlocks(int32 numSamples);
+  void sliceInputChanges(int32 begin, int32 end);
+  void advanceProcessContext(int32 numSamples);
   void initProcessData();
   void initProcessContext();
   bool updateProcessSetup();
   void preprocess(Buffers &buffers, int64_t continousFrames);
   void postprocess(Buffers &buffers);
-  bool isPortInRange(int32 port, int32 channel) const;
   bool processVstEvent(const IMidiClient::Event &event, int32 port);
+  bool processSysEx(const IMidiClient::Event &event, int32 port);
   bool processParamChange(const IMidiClient::Event &event, int32 port);
+  bool processChannelMode(const IMidiClient::Event &event, int32 port);
+  void addVstEvent(Vst::Event &event, int32 port, int64_t timestamp);
+  void addParameterPoint(ParamID id, ParamValue value, int32 sampleOffset);
+  MidiInputChannel *findMidiInputChannel(int32 port, int32 channel);
+  void drainEventQueue();
+  void drainParameterQueue();
+  void drainOutputParameterChanges();
 
   SampleRate sampleRate = 0;
   int32 blockSize = 0;
   HostProcessData processData;
+
+  //! Channel buffer slots of processData in server buffer order.
+  using ChannelRoutes = std::vector<Sample32 **>;
+  ChannelRoutes inputRoutes;
+  ChannelRoutes outputRoutes;
+  std::vector<Sample32> scratchBuffers;
+
+  //! kSample64 only: converted channel buffers in server buffer order.
+  using ChannelBuffers64 = std::vector<Sample64 *>;
+  ChannelBuffers64 inputBuffers64;
+  ChannelBuffers64 outputBuffers64;
+  std::vector<Sample64> scratchBuffers64;
+  int32 symbolicSampleSize = kSample32;
+  int32 processMode = kRealtime;
+
+  //! Sub-block processing: every channel slot of processData (inputs first)
+  //! and the period's buffer pointers they are offset from.
+  int32 subBlockSize = 0;
+  std::vector<void **> channelSlots;
+  std::vector<void *> periodBuffers;
+  ParameterChanges subBlockParameterChanges;
+  EventList subBlockEventList;
+
+  struct QueuedEvent {
+    Event event;
+    int32_t port;
+  };
+  SPSCQueue<QueuedEvent> eventQueue;
+  bool eventQueueDrained = false;
+
+  struct QueuedParameter {
+    ParamID id;
+    ParamValue value;
+    int32 sampleOffset;
+  };
+  SPSCQueue<QueuedParameter> parameterQueue;
+  SPSCQueue<QueuedParameter> outputParameterQueue;
+  std::unordered_map<ParamID, ParamValue> outputValues;
+
   ProcessContext processContext;
   EventList eventList;
   ParameterChanges inputParameterChanges;
+  ParameterChanges outputParameterChanges;
   IComponent *component = nullptr;
-  ParameterChangeTransfer paramTransferrer;
+  IEditController *editController = nullptr;
+  FUnknownPtr<IAudioProcessor> processor;
 
   MidiCCMapping midiCCMapping;
+  MidiInputChannels midiInputChannels;
+  //! Copies of this block's SysEx messages, referenced by the data events.
+  std::vector<uint8> sysExBuffer;
+  size_t sysExBufferUsed = 0;
   IMediaServerPtr mediaServer;
   bool isProcessing = false;
+  std::atomic<bool> suspended{false};
+  std::atomic<bool> inProcess{false};
+  std::atomic<int32> pendingRestartFlags{0};
+  //! Serializes the callers of updateProcessSetup(), the server calls
+  //! setSamplerate and setBlockSize from its own thread.
+  std::mutex setupMutex;
+  ProcessStatistics processStatistics;
+  RTGuard::Counters rtCounters;
+  bool countPageFaults = false;
 
   Name name;
 };
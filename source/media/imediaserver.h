@@ -29,7 +29,9 @@
 
 #pragma once
 
+#include "source/media/realtime.h"
 #include <memory>
+#include <pluginterfaces/vst/ivstprocesscontext.h>
 #include <pluginterfaces/vst/vsttypes.h>
 #include <string>
 #include <vector>
@@ -48,6 +50,9 @@ struct IAudioClient {
     float **outputs;
     int32_t numOutputs;
     int32_t numSamples;
+    //! Transport and tempo of this period if the server has them, the
+    //! client keeps its own ProcessContext otherwise.
+    const ProcessContext *processContext = nullptr;
   };
 
   struct IOSetup {
@@ -73,6 +78,10 @@ struct IMidiClient {
     MidiData data0;
     MidiData data1;
     int64_t timestamp;
+    //! SysEx (type 0xF0) only: the bytes following the F0 status, including
+    //! the terminating F7. Owned by the server, valid during onEvent().
+    const MidiData *sysExData = nullptr;
+    uint32_t sysExSize = 0;
   };
 
   struct IOSetup {
@@ -97,7 +106,8 @@ struct IMediaServer {
 //----------------------------------------------------------------------------------
 using IMediaServerPtr = std::shared_ptr<IMediaServer>;
 
-IMediaServerPtr createMediaServer(const AudioClientName &name);
+IMediaServerPtr createMediaServer(const AudioClientName &name,
+                                  const RealtimeOptions &options = {});
 //----------------------------------------------------------------------------------
 } // namespace Vst
 } // namespace Steinberg
@@ -28,8 +28,10 @@
 //-----------------------------------------------------------------------------
 
 #include "source/media/imediaserver.h"
+#include "source/media/miditovst.h"
 
 #include <cassert>
+#include <cstdio>
 
 //! Workaround for Jack on Windows
 #if defined(SMTG_OS_WINDOWS) && defined(_STDINT)
@@ -38,6 +40,7 @@
 
 #include <jack/jack.h>
 #include <jack/midiport.h>
+#include <jack/transport.h>
 
 //------------------------------------------------------------------------
 namespace Steinberg {
@@ -60,7 +63,7 @@ public:
   bool registerAudioClient(IAudioClient *client) override;
   bool registerMidiClient(IMidiClient *client) override;
 
-  bool initialize(JackName name);
+  bool initialize(JackName name, const RealtimeOptions &options);
 
   // jack process callback
   int process(jack_nframes_t nframes);
@@ -78,6 +81,8 @@ private:
   bool autoConnectAudioPorts(jack_client_t *client);
   bool autoConnectMidiPorts(jack_client_t *client);
   void updateAudioBuffers(jack_nframes_t nframes);
+  void updateProcessContext();
+  void configureProcessThread();
 
   // Jack objects
   jack_client_t *jackClient = nullptr;
@@ -91,6 +96,8 @@ private:
   BufferPointers audioOutputPointers;
   BufferPointers audioInputPointers;
   IAudioClient::Buffers buffers{nullptr};
+  ProcessContext processContext{};
+  RealtimeOptions realtimeOptions;
 };
 
 //------------------------------------------------------------------------
@@ -114,14 +121,19 @@ int jack_on_set_block_size(jack_nframes_t nframes, void *arg) {
 }
 
 //------------------------------------------------------------------------
-IMediaServerPtr createMediaServer(const AudioClientName &name) {
+IMediaServerPtr createMediaServer(const AudioClientName &name,
+                                  const RealtimeOptions &options) {
   auto client = std::make_shared<JackClient>();
-  client->initialize(name);
+  if (!client->initialize(name, options))
+    return nullptr;
   return client;
 }
 
 //------------------------------------------------------------------------
 JackClient::~JackClient() {
+  if (!jackClient)
+    return;
+
   //! We do not need to "unregister" ports. It is done automatically with
   //! "jack_client_close"
   jack_deactivate(jackClient); // Stops calls of process
@@ -144,10 +156,19 @@ bool JackClient::registerAudioClient(IAudioClient *client) {
   if (!setupJackProcessCallbacks(jackClient))
     return false;
 
+  //! The callbacks only report changes, so announce the current setup once.
+  audioClient->setSamplerate(
+      static_cast<SampleRate>(jack_get_sample_rate(jackClient)));
+  audioClient->setBlockSize(
+      static_cast<int32>(jack_get_buffer_size(jackClient)));
+
   //! Activate after defining the callbacks. It is said in the documentation.
   if (jack_activate(jackClient) != kJackSuccess)
     return false;
 
+  //! The process thread exists once the client is active.
+  configureProcessThread();
+
   //! AFTER activation, register the ports.
   if (!autoConnectAudioPorts(jackClient))
     return false;
@@ -174,7 +195,13 @@ bool JackClient::registerMidiClient(IMidiClient *client) {
 }
 
 //------------------------------------------------------------------------
-bool JackClient::initialize(JackClient::JackName name) {
+bool JackClient::initialize(JackClient::JackName name,
+                            const RealtimeOptions &options) {
+  realtimeOptions = options;
+  std::string error;
+  if (!lockProcessMemory(realtimeOptions, error))
+    std::printf("%s\n", error.data());
+
   jackClient = registerClient(name);
   if (!jackClient)
     return false;
@@ -182,6 +209,16 @@ bool JackClient::initialize(JackClient::JackName name) {
   return true;
 }
 
+//------------------------------------------------------------------------
+void JackClient::configureProcessThread() {
+  auto thread = jack_client_thread_id(jackClient);
+  std::string error;
+  if (!configureRealtimeThread(thread, realtimeOptions, error))
+    std::printf("%s\n", error.data());
+  std::printf("JACK process thread: %s\n",
+              describeThreadScheduling(thread).data());
+}
+
 //------------------------------------------------------------------------
 void JackClient::updateAudioBuffers(jack_nframes_t nframes) {
   int outputIndex = 0;
@@ -214,6 +251,9 @@ int JackClient::process(jack_nframes_t nframes) {
   if (!audioClient)
     return 0;
 
+  updateProcessContext();
+  buffers.processContext = &processContext;
+
   if (audioClient->process(buffers, jack_last_frame_time(jackClient)) ==
       false) {
     assert(false);
@@ -222,6 +262,45 @@ int JackClient::process(jack_nframes_t nframes) {
   return kJackSuccess;
 }
 
+//------------------------------------------------------------------------
+void JackClient::updateProcessContext() {
+  jack_position_t position;
+  auto state = jack_transport_query(jackClient, &position);
+
+  processContext.state = ProcessContext::kSystemTimeValid;
+  if (state == JackTransportRolling)
+    processContext.state |= ProcessContext::kPlaying;
+  processContext.sampleRate = position.frame_rate;
+  processContext.projectTimeSamples = position.frame;
+  processContext.systemTime = static_cast<int64>(position.usecs) * 1000;
+
+  if ((position.valid & JackPositionBBT) == 0 || position.beat_type <= 0.f) {
+    //! Some plug-ins use the tempo regardless of kTempoValid.
+    processContext.tempo = 120.;
+    processContext.timeSigNumerator = 4;
+    processContext.timeSigDenominator = 4;
+    return;
+  }
+
+  //! JACK counts bars and beats from 1, VST3 measures music in quarters.
+  auto quartersPerBeat = 4. / position.beat_type;
+  auto barStart = (position.bar - 1) * position.beats_per_bar;
+  auto beat = (position.beat - 1) +
+              (position.ticks_per_beat > 0.
+                   ? position.tick / position.ticks_per_beat
+                   : 0.);
+
+  processContext.state |= ProcessContext::kTempoValid |
+                          ProcessContext::kTimeSigValid |
+                          ProcessContext::kProjectTimeMusicValid |
+                          ProcessContext::kBarPositionValid;
+  processContext.tempo = position.beats_per_minute;
+  processContext.timeSigNumerator = static_cast<int32>(position.beats_per_bar);
+  processContext.timeSigDenominator = static_cast<int32>(position.beat_type);
+  processContext.projectTimeMusic = (barStart + beat) * quartersPerBeat;
+  processContext.barPositionMusic = barStart * quartersPerBeat;
+}
+
 //------------------------------------------------------------------------
 bool JackClient::registerAudioPorts(IAudioClient *processor) {
   auto ioSetup = processor->getIOSetup();
@@ -269,7 +348,7 @@ bool JackClient::addAudioInputPort(JackClient::JackName name) {
     return false;
 
   audioInputPorts.push_back(port);
-  audioInputPointers.resize(audioOutputPorts.size());
+  audioInputPointers.resize(audioInputPorts.size());
   return true;
 }
 
@@ -286,9 +365,8 @@ bool JackClient::addMidiInputPort(JackClient::JackName name) {
 
 //------------------------------------------------------------------------
 int JackClient::processMidi(jack_nframes_t nframes) {
-  static const uint8_t kChannelMask = 0x0F;
-  static const uint8_t kStatusMask = 0xF0;
-  static const uint32_t kDataMask = 0x7F;
+  if (!midiClient)
+    return kJackSuccess;
 
   for (int32_t portIndex = 0,
                count = static_cast<int32_t>(midiInputPorts.size());
@@ -299,20 +377,14 @@ int JackClient::processMidi(jack_nframes_t nframes) {
       continue;
 
     jack_midi_event_t in_event;
+    IMidiClient::Event event;
     auto event_count = jack_midi_get_event_count(portBuffer);
     for (uint32_t i = 0; i < event_count; i++) {
       jack_midi_event_get(&in_event, portBuffer, i);
-      if (in_event.size == 0)
-        continue;
-
-      auto midiData = in_event.buffer;
-      Steinberg::Vst::IMidiClient::MidiData channel =
-          midiData[0] & kChannelMask;
-      Steinberg::Vst::IMidiClient::MidiData status = midiData[0] & kStatusMask;
-      Steinberg::Vst::IMidiClient::MidiData data0 = midiData[1];
-      Steinberg::Vst::IMidiClient::MidiData data1 = midiData[2];
-      midiClient->onEvent({status, channel, data0, data1, in_event.time},
-                          portIndex);
+      // JACK delivers complete messages without running status.
+      if (decodeMidiMessage(in_event.buffer, in_event.size, in_event.time,
+                            event))
+        midiClient->onEvent(event, portIndex);
     }
   }
 
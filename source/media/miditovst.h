@@ -32,7 +32,9 @@
 #include "pluginterfaces/vst/ivstevents.h"
 #include "pluginterfaces/vst/ivstmidicontrollers.h"
 #include "public.sdk/source/vst/utility/optional.h"
-#include <functional>
+#include "source/media/imediaserver.h"
+#include <array>
+#include <bitset>
 
 //------------------------------------------------------------------------
 namespace Steinberg {
@@ -45,21 +47,135 @@ const uint8_t kController = 0xB0;          ///< controller, value
 const uint8_t kProgramChangeStatus = 0xC0; ///< program change
 const uint8_t kAfterTouchStatus = 0xD0;    ///< channel pressure
 const uint8_t kPitchBendStatus = 0xE0;     ///< lsb, msb
+const uint8_t kSysExStatus = 0xF0;         ///< see IMidiClient::Event
 static const uint32 kDataMask = 0x7F;
+static const uint32 kStatusMask = 0xF0;
+static const uint32 kChannelMask = 0x0F;
 
 const float kMidiScaler = 1.f / 127.f;
+const double kMidi14BitScaler = 1. / (double)0x3FFF;
 
 using MidiData = uint8_t;
 
-float toNormalized(const MidiData &data) { return (float)data * kMidiScaler; }
+inline float toNormalized(const MidiData &data) {
+  return (float)data * kMidiScaler;
+}
 
 using OptionalEvent = VST3::Optional<Event>;
 
 using ParameterChange = std::pair<ParamID, ParamValue>;
 using OptionParamChange = VST3::Optional<ParameterChange>;
 
-OptionalEvent midiToEvent(MidiData status, MidiData channel, MidiData midiData0,
-                          MidiData midiData1) {
+//------------------------------------------------------------------------
+//! Number of data bytes following the status byte of a channel message.
+inline int32 midiDataLength(MidiData status) {
+  switch (status & kStatusMask) {
+  case kProgramChangeStatus:
+  case kAfterTouchStatus:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+//------------------------------------------------------------------------
+/** Splits one complete MIDI 1.0 message into an event. Only the data bytes
+ *  the status calls for are read; SysEx refers to the message bytes.
+ *  Returns false for truncated messages, stray data bytes and system common
+ *  and realtime messages, which have no VST 3 counterpart.
+ */
+inline bool decodeMidiMessage(const MidiData *data, size_t size,
+                              int64_t timestamp, IMidiClient::Event &event) {
+  if (size == 0 || (data[0] & 0x80) == 0)
+    return false;
+
+  event = {};
+  event.timestamp = timestamp;
+  if (data[0] == kSysExStatus) {
+    event.type = kSysExStatus;
+    event.sysExData = data + 1;
+    event.sysExSize = static_cast<uint32_t>(size - 1);
+    return true;
+  }
+  if (data[0] > kSysExStatus)
+    return false;
+
+  auto length = midiDataLength(data[0]);
+  if (size < static_cast<size_t>(length) + 1)
+    return false;
+  event.type = data[0] & kStatusMask;
+  event.channel = data[0] & kChannelMask;
+  event.data0 = data[1] & kDataMask;
+  event.data1 = length > 1 ? data[2] & kDataMask : 0;
+  // note on with velocity 0 is a note off
+  if (event.type == kNoteOn && event.data1 == 0)
+    event.type = kNoteOff;
+  return true;
+}
+
+//------------------------------------------------------------------------
+/** What a MIDI channel remembers between messages: the held notes, to
+ *  release them on channel mode messages, and the last controller MSBs, to
+ *  pair them with their LSBs. Fixed size, updated on the audio thread.
+ */
+class MidiChannelState {
+public:
+  MidiChannelState() { msb.fill(kNoValue); }
+
+  void noteOn(MidiData pitch) { heldNotes.set(pitch & kDataMask); }
+  void noteOff(MidiData pitch) { heldNotes.reset(pitch & kDataMask); }
+
+  //! Calls releaseNote(pitch) for every held note and forgets them.
+  template <typename ReleaseNote> void releaseNotes(ReleaseNote &&releaseNote) {
+    if (heldNotes.none())
+      return;
+    for (int32 pitch = 0; pitch < static_cast<int32>(heldNotes.size());
+         ++pitch) {
+      if (heldNotes.test(pitch))
+        releaseNote(static_cast<MidiData>(pitch));
+    }
+    heldNotes.reset();
+  }
+
+  /** Tracks the controller pairs n (MSB) and n + 32 (LSB) for n < 32.
+   *  Returns the 14-bit value when an LSB follows its MSB, -1 otherwise. An
+   *  (N)RPN selection forgets the data entry MSB, so its LSB is not paired
+   *  with a value meant for the previous parameter.
+   */
+  int32 controller(MidiData number, MidiData value) {
+    if (number < kNumPairs) {
+      msb[number] = static_cast<int8_t>(value & kDataMask);
+      return -1;
+    }
+    if (number < 2 * kNumPairs) {
+      auto high = msb[number - kNumPairs];
+      return high == kNoValue ? -1 : (high << 7) | (value & kDataMask);
+    }
+    if (number >= kCtrlNRPNSelectLSB && number <= kCtrlRPNSelectMSB)
+      msb[kCtrlDataEntryMSB] = kNoValue;
+    return -1;
+  }
+
+  void resetControllers() { msb.fill(kNoValue); }
+
+private:
+  static constexpr int32 kNumPairs = 32;
+  static constexpr int8_t kNoValue = -1;
+
+  std::bitset<128> heldNotes;
+  std::array<int8_t, kNumPairs> msb;
+};
+
+//------------------------------------------------------------------------
+//! Program change parameter of the unit a MIDI channel plays.
+struct MidiProgramTarget {
+  ParamID id = kNoParamId;
+  int32 programCount = 0;
+};
+
+//------------------------------------------------------------------------
+inline OptionalEvent midiToEvent(MidiData status, MidiData channel,
+                                 MidiData midiData0, MidiData midiData1) {
   Event new_event = {};
   if (status == kNoteOn || status == kNoteOff) {
     if (status == kNoteOff) // note off
@@ -94,28 +210,50 @@ OptionalEvent midiToEvent(MidiData status, MidiData channel, MidiData midiData0,
 }
 
 //------------------------------------------------------------------------
-using ToParameterIdFunc = std::function<ParamID(int32, MidiData)>;
-OptionParamChange midiToParameter(MidiData status, MidiData channel,
-                                  MidiData midiData1, MidiData midiData2,
-                                  const ToParameterIdFunc &toParamID) {
-  if (!toParamID)
-    return {};
+//! bytes must stay valid until the processor is done with the event.
+inline Event sysExToEvent(const uint8 *bytes, uint32 size) {
+  Event new_event = {};
+  new_event.type = Event::kDataEvent;
+  new_event.data.type = DataEvent::kMidiSysEx;
+  new_event.data.size = size;
+  new_event.data.bytes = bytes;
+  return new_event;
+}
 
+//------------------------------------------------------------------------
+//! toParamID(int32 channel, int32 controller) -> ParamID is called inline,
+//! controller is the CC number, kPitchBend or kAfterTouch.
+//! toProgram(int32 channel) -> MidiProgramTarget resolves program changes.
+//! state is the one of the event's channel.
+template <typename ToParamID, typename ToProgram>
+inline OptionParamChange midiToParameter(MidiData status, MidiData channel,
+                                         MidiData midiData1,
+                                         MidiData midiData2,
+                                         MidiChannelState &state,
+                                         ToParamID &&toParamID,
+                                         ToProgram &&toProgram) {
   ParameterChange paramChange;
   if (status == kController) // controller
   {
+    auto value14Bit = state.controller(midiData1, midiData2);
     paramChange.first = toParamID(channel, midiData1);
     if (paramChange.first != kNoParamId) {
       paramChange.second = (double)midiData2 * kMidiScaler;
       return paramChange;
     }
+    // an unmapped LSB refines the parameter of its MSB
+    if (value14Bit >= 0) {
+      paramChange.first = toParamID(channel, midiData1 - 32);
+      if (paramChange.first != kNoParamId) {
+        paramChange.second = kMidi14BitScaler * (double)value14Bit;
+        return paramChange;
+      }
+    }
   } else if (status == kPitchBendStatus) {
     paramChange.first = toParamID(channel, Vst::kPitchBend);
     if (paramChange.first != kNoParamId) {
-      const double kPitchWheelScaler = 1. / (double)0x3FFF;
-
       const int32 ctrl = (midiData1 & kDataMask) | (midiData2 & kDataMask) << 7;
-      paramChange.second = kPitchWheelScaler * (double)ctrl;
+      paramChange.second = kMidi14BitScaler * (double)ctrl;
       return paramChange;
     };
   } else if (status == kAfterTouchStatus) {
@@ -125,7 +263,15 @@ OptionParamChange midiToParameter(MidiData status, MidiData channel,
       return paramChange;
     };
   } else if (status == kProgramChangeStatus) {
-    // TODO
+    MidiProgramTarget target = toProgram(channel);
+    if (target.id != kNoParamId && midiData1 < target.programCount) {
+      paramChange.first = target.id;
+      paramChange.second =
+          target.programCount > 1
+              ? (ParamValue)midiData1 / (ParamValue)(target.programCount - 1)
+              : 0.;
+      return paramChange;
+    }
   }
 
   return {};
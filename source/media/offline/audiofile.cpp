@@ -0,0 +1,454 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/offline/audiofile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+static const uint16 kWaveFormatPCM = 0x0001;
+static const uint16 kWaveFormatFloat = 0x0003;
+static const uint16 kWaveFormatExtensible = 0xFFFE;
+//! RIFF, JUNK (ds64 in RF64 files), fmt and data chunk headers.
+static const uint32 kWaveHeaderSize = 80;
+static const uint32 kDs64Size = 28;
+static const uint32 kSizeInDs64 = 0xFFFFFFFF;
+//! Interleaved bytes per writer chunk.
+static const size_t kWriterChunkBytes = 4 << 20;
+//! The reader releases consumed pages in steps of this size.
+static const int64 kReleaseBytes = 8 << 20;
+
+//------------------------------------------------------------------------
+static uint16 readLE16(const uint8 *data) {
+  return static_cast<uint16>(data[0] | (data[1] << 8));
+}
+
+//------------------------------------------------------------------------
+static uint32 readLE32(const uint8 *data) {
+  return static_cast<uint32>(data[0]) | (static_cast<uint32>(data[1]) << 8) |
+         (static_cast<uint32>(data[2]) << 16) |
+         (static_cast<uint32>(data[3]) << 24);
+}
+
+//------------------------------------------------------------------------
+static uint64 readLE64(const uint8 *data) {
+  return static_cast<uint64>(readLE32(data)) |
+         (static_cast<uint64>(readLE32(data + 4)) << 32);
+}
+
+//------------------------------------------------------------------------
+static void writeLE16(uint8 *data, uint16 value) {
+  data[0] = static_cast<uint8>(value);
+  data[1] = static_cast<uint8>(value >> 8);
+}
+
+//------------------------------------------------------------------------
+static void writeLE32(uint8 *data, uint32 value) {
+  for (int i = 0; i < 4; ++i)
+    data[i] = static_cast<uint8>(value >> (8 * i));
+}
+
+//------------------------------------------------------------------------
+static void writeLE64(uint8 *data, uint64 value) {
+  writeLE32(data, static_cast<uint32>(value));
+  writeLE32(data + 4, static_cast<uint32>(value >> 32));
+}
+
+//------------------------------------------------------------------------
+static bool endsWith(const std::string &str, const std::string &suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+//------------------------------------------------------------------------
+//! Converts one channel, the encoding is resolved outside of the loop.
+template <typename Decode>
+static void deinterleave(const uint8 *src, int32 frameSize, int32 numFrames,
+                         float *dest, Decode decode) {
+  for (int32 i = 0; i < numFrames; ++i, src += frameSize)
+    dest[i] = decode(src);
+}
+
+//------------------------------------------------------------------------
+//  AudioFileReader
+//------------------------------------------------------------------------
+AudioFileReader::~AudioFileReader() = default;
+
+//------------------------------------------------------------------------
+auto AudioFileReader::open(const std::string &path, std::string &error)
+    -> Ptr {
+  Ptr reader(new AudioFileReader);
+  if (!reader->file.open(path, true, error)) {
+    error = "Could not open audio file " + path;
+    return nullptr;
+  }
+  if (!reader->readWaveHeader(error)) {
+    error = path + ": " + error;
+    return nullptr;
+  }
+  reader->releasedPos = reader->file.data();
+  return reader;
+}
+
+//------------------------------------------------------------------------
+auto AudioFileReader::openRaw(const std::string &path, int32 numChannels,
+                              SampleRate sampleRate, std::string &error)
+    -> Ptr {
+  if (numChannels <= 0) {
+    error = "Raw audio files need a channel count";
+    return nullptr;
+  }
+
+  Ptr reader(new AudioFileReader);
+  if (!reader->file.open(path, true, error)) {
+    error = "Could not open audio file " + path;
+    return nullptr;
+  }
+
+  reader->encoding = Encoding::kFloat32;
+  reader->bytesPerSample = sizeof(float);
+  reader->numChannels = numChannels;
+  reader->sampleRate = sampleRate;
+  reader->numFrames =
+      reader->file.size() / (numChannels * reader->bytesPerSample);
+  reader->framesLeft = reader->numFrames;
+  reader->readPos = reader->file.data();
+  reader->releasedPos = reader->file.data();
+  return reader;
+}
+
+//------------------------------------------------------------------------
+bool AudioFileReader::readWaveHeader(std::string &error) {
+  auto pos = file.data();
+  auto end = pos + file.size();
+  if (file.size() < 12 || std::memcmp(pos + 8, "WAVE", 4) != 0 ||
+      (std::memcmp(pos, "RIFF", 4) != 0 && std::memcmp(pos, "RF64", 4) != 0 &&
+       std::memcmp(pos, "BW64", 4) != 0)) {
+    error = "Not a RIFF/WAVE or RF64 file";
+    return false;
+  }
+  pos += 12;
+
+  bool hasFormat = false;
+  uint64 dataSize64 = 0;
+  while (end - pos >= 8) {
+    uint64 chunkSize = readLE32(pos + 4);
+    auto chunk = pos + 8;
+    if (std::memcmp(pos, "ds64", 4) == 0) {
+      if (chunkSize < 24 || end - chunk < 24) {
+        error = "Truncated ds64 chunk";
+        return false;
+      }
+      dataSize64 = readLE64(chunk + 8);
+    } else if (std::memcmp(pos, "fmt ", 4) == 0) {
+      if (chunkSize < 16 || static_cast<uint64>(end - chunk) < chunkSize) {
+        error = "Truncated fmt chunk";
+        return false;
+      }
+      auto formatTag = readLE16(chunk);
+      numChannels = readLE16(chunk + 2);
+      sampleRate = readLE32(chunk + 4);
+      auto bitsPerSample = readLE16(chunk + 14);
+      if (formatTag == kWaveFormatExtensible && chunkSize >= 26)
+        formatTag = readLE16(chunk + 24); // first bytes of the sub format GUID
+
+      if (formatTag == kWaveFormatPCM && bitsPerSample == 16)
+        encoding = Encoding::kInt16;
+      else if (formatTag == kWaveFormatPCM && bitsPerSample == 24)
+        encoding = Encoding::kInt24;
+      else if (formatTag == kWaveFormatPCM && bitsPerSample == 32)
+        encoding = Encoding::kInt32;
+      else if (formatTag == kWaveFormatFloat && bitsPerSample == 32)
+        encoding = Encoding::kFloat32;
+      else if (formatTag == kWaveFormatFloat && bitsPerSample == 64)
+        encoding = Encoding::kFloat64;
+      else {
+        error = "Unsupported WAVE sample format";
+        return false;
+      }
+      bytesPerSample = bitsPerSample / 8;
+      hasFormat = true;
+    } else if (std::memcmp(pos, "data", 4) == 0) {
+      if (!hasFormat || numChannels == 0) {
+        error = "data chunk before fmt chunk";
+        return false;
+      }
+      if (chunkSize == kSizeInDs64 && dataSize64 > 0)
+        chunkSize = dataSize64;
+      // a file cut short is read as far as it goes
+      chunkSize = std::min<uint64>(chunkSize, end - chunk);
+      numFrames =
+          static_cast<int64>(chunkSize) / (numChannels * bytesPerSample);
+      framesLeft = numFrames;
+      readPos = chunk;
+      return true;
+    }
+    if (static_cast<uint64>(end - chunk) < chunkSize + (chunkSize & 1))
+      break;
+    pos = chunk + chunkSize + (chunkSize & 1);
+  }
+
+  error = "No data chunk found";
+  return false;
+}
+
+//------------------------------------------------------------------------
+void AudioFileReader::releaseConsumedPages() {
+  if (readPos - releasedPos < kReleaseBytes)
+    return;
+  auto pageSize = sysconf(_SC_PAGESIZE);
+  auto offset = releasedPos - file.data();
+  auto begin = offset - offset % pageSize;
+  auto length = (readPos - file.data()) - begin;
+  length -= length % pageSize;
+  madvise(const_cast<uint8 *>(file.data() + begin),
+          static_cast<size_t>(length), MADV_DONTNEED);
+  releasedPos = file.data() + begin + length;
+}
+
+//------------------------------------------------------------------------
+int32 AudioFileReader::read(float **channels, int32 channelCount,
+                            int32 numFrames) {
+  auto frames = static_cast<int32>(std::min<int64>(numFrames, framesLeft));
+  auto frameSize = numChannels * bytesPerSample;
+
+  for (int32 c = 0; c < channelCount; ++c) {
+    auto *dest = channels[c];
+    if (c >= numChannels) {
+      std::fill(dest, dest + numFrames, 0.f);
+      continue;
+    }
+
+    const auto *src = readPos + c * bytesPerSample;
+    switch (encoding) {
+    case Encoding::kInt16:
+      deinterleave(src, frameSize, frames, dest, [](const uint8 *data) {
+        return static_cast<int16>(readLE16(data)) * (1.f / 32768.f);
+      });
+      break;
+    case Encoding::kInt24:
+      deinterleave(src, frameSize, frames, dest, [](const uint8 *data) {
+        auto value = static_cast<int32>((static_cast<uint32>(data[0]) << 8) |
+                                        (static_cast<uint32>(data[1]) << 16) |
+                                        (static_cast<uint32>(data[2]) << 24));
+        return (value >> 8) * (1.f / 8388608.f);
+      });
+      break;
+    case Encoding::kInt32:
+      deinterleave(src, frameSize, frames, dest, [](const uint8 *data) {
+        return static_cast<int32>(readLE32(data)) * (1.f / 2147483648.f);
+      });
+      break;
+    case Encoding::kFloat32:
+      deinterleave(src, frameSize, frames, dest, [](const uint8 *data) {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+      });
+      break;
+    case Encoding::kFloat64:
+      deinterleave(src, frameSize, frames, dest, [](const uint8 *data) {
+        double value;
+        std::memcpy(&value, data, sizeof(value));
+        return static_cast<float>(value);
+      });
+      break;
+    }
+    std::fill(dest + frames, dest + numFrames, 0.f);
+  }
+
+  readPos += static_cast<int64>(frames) * frameSize;
+  framesLeft -= frames;
+  releaseConsumedPages();
+  return frames;
+}
+
+//------------------------------------------------------------------------
+//  AudioFileWriter
+//------------------------------------------------------------------------
+AudioFileWriter::~AudioFileWriter() { close(); }
+
+//------------------------------------------------------------------------
+auto AudioFileWriter::create(const std::string &path, int32 numChannels,
+                             SampleRate sampleRate, std::string &error)
+    -> Ptr {
+  if (numChannels <= 0) {
+    error = "Cannot write an audio file without channels";
+    return nullptr;
+  }
+
+  Ptr writer(new AudioFileWriter);
+  writer->file = std::fopen(path.data(), "wb");
+  if (!writer->file) {
+    error = "Could not create audio file " + path;
+    return nullptr;
+  }
+  // chunks are written whole, stdio buffering would only copy them again
+  std::setvbuf(writer->file, nullptr, _IONBF, 0);
+  writer->isRaw = endsWith(path, ".raw");
+  writer->numChannels = numChannels;
+  writer->sampleRate = sampleRate;
+  if (!writer->isRaw && !writer->writeWaveHeader()) {
+    error = "Could not write WAVE header to " + path;
+    // the writer thread was not started, close() must not join it
+    std::fclose(writer->file);
+    writer->file = nullptr;
+    return nullptr;
+  }
+
+  writer->chunkFrames = static_cast<int32>(std::max<size_t>(
+      kWriterChunkBytes / (numChannels * sizeof(float)), 1));
+  for (auto &chunk : writer->chunks)
+    chunk.samples.resize(static_cast<size_t>(writer->chunkFrames) *
+                         numChannels);
+  writer->thread = std::thread([w = writer.get()]() { w->writerThread(); });
+  return writer;
+}
+
+//------------------------------------------------------------------------
+bool AudioFileWriter::writeWaveHeader() {
+  auto dataSize = static_cast<uint64>(numFrames) * numChannels * sizeof(float);
+  auto riffSize = kWaveHeaderSize - 8 + dataSize;
+  auto isRF64 = riffSize > 0xFFFFFFFFu;
+
+  uint8 header[kWaveHeaderSize] = {};
+  std::memcpy(header, isRF64 ? "RF64" : "RIFF", 4);
+  writeLE32(header + 4, isRF64 ? kSizeInDs64 : static_cast<uint32>(riffSize));
+  std::memcpy(header + 8, "WAVE", 4);
+  // reserved as JUNK, so the header can become RF64 at close
+  std::memcpy(header + 12, isRF64 ? "ds64" : "JUNK", 4);
+  writeLE32(header + 16, kDs64Size);
+  if (isRF64) {
+    writeLE64(header + 20, riffSize);
+    writeLE64(header + 28, dataSize);
+    writeLE64(header + 36, static_cast<uint64>(numFrames));
+  }
+  std::memcpy(header + 48, "fmt ", 4);
+  writeLE32(header + 52, 16);
+  writeLE16(header + 56, kWaveFormatFloat);
+  writeLE16(header + 58, static_cast<uint16>(numChannels));
+  writeLE32(header + 60, static_cast<uint32>(sampleRate));
+  writeLE32(header + 64, static_cast<uint32>(sampleRate) * numChannels *
+                             sizeof(float));
+  writeLE16(header + 68, static_cast<uint16>(numChannels * sizeof(float)));
+  writeLE16(header + 70, 32);
+  std::memcpy(header + 72, "data", 4);
+  writeLE32(header + 76,
+            isRF64 ? kSizeInDs64 : static_cast<uint32>(dataSize));
+  return std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+//------------------------------------------------------------------------
+void AudioFileWriter::writerThread() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    condition.wait(lock, [this]() {
+      return pendingIndex != kNoChunk || stopping;
+    });
+    if (pendingIndex == kNoChunk)
+      return;
+
+    auto &chunk = chunks[pendingIndex];
+    lock.unlock();
+    auto count = static_cast<size_t>(chunk.numFrames) * numChannels;
+    if (std::fwrite(chunk.samples.data(), sizeof(float), count, file) != count)
+      failed = true;
+    lock.lock();
+    pendingIndex = kNoChunk;
+    condition.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------
+void AudioFileWriter::submitChunk() {
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this]() { return pendingIndex == kNoChunk; });
+  pendingIndex = fillIndex;
+  fillIndex = (fillIndex + 1) % chunks.size();
+  chunks[fillIndex].numFrames = 0;
+  condition.notify_all();
+}
+
+//------------------------------------------------------------------------
+bool AudioFileWriter::write(float *const *channels, int32 frames) {
+  if (!file || failed)
+    return false;
+
+  int32 offset = 0;
+  while (offset < frames) {
+    auto &chunk = chunks[fillIndex];
+    auto count = std::min(frames - offset, chunkFrames - chunk.numFrames);
+    auto *dest = chunk.samples.data() +
+                 static_cast<size_t>(chunk.numFrames) * numChannels;
+    for (int32 i = offset; i < offset + count; ++i)
+      for (int32 c = 0; c < numChannels; ++c)
+        *dest++ = channels[c][i];
+    chunk.numFrames += count;
+    offset += count;
+    if (chunk.numFrames == chunkFrames)
+      submitChunk();
+  }
+
+  numFrames += frames;
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool AudioFileWriter::close() {
+  if (!file)
+    return true;
+
+  if (chunks[fillIndex].numFrames > 0)
+    submitChunk();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    condition.notify_all();
+  }
+  thread.join();
+
+  bool result = !failed;
+  if (!isRaw) {
+    std::fseek(file, 0, SEEK_SET);
+    result = writeWaveHeader() && result;
+  }
+  result = std::fclose(file) == 0 && result;
+  file = nullptr;
+  return result;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pluginterfaces/vst/vsttypes.h"
+#include "source/media/offline/mappedfile.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+/** Streaming reader for WAV and RF64 (PCM 16/24/32 bit, float 32/64 bit)
+ *  and raw interleaved float32 files.
+ *
+ *  The file is memory mapped with sequential read-ahead and converted
+ *  straight into the destination channels; pages behind the read position
+ *  are released, so memory use stays flat for files of any length.
+ */
+class AudioFileReader {
+public:
+  using Ptr = std::unique_ptr<AudioFileReader>;
+
+  ~AudioFileReader();
+
+  static Ptr open(const std::string &path, std::string &error);
+  static Ptr openRaw(const std::string &path, int32 numChannels,
+                     SampleRate sampleRate, std::string &error);
+
+  int32 getNumChannels() const { return numChannels; }
+  SampleRate getSampleRate() const { return sampleRate; }
+  int64 getNumFrames() const { return numFrames; }
+
+  /** Reads up to numFrames frames and deinterleaves them into channels.
+   *  File channels without a destination are dropped, destinations without a
+   *  file channel are cleared. Returns the number of frames read.
+   */
+  int32 read(float **channels, int32 channelCount, int32 numFrames);
+
+private:
+  enum class Encoding { kInt16, kInt24, kInt32, kFloat32, kFloat64 };
+
+  AudioFileReader() = default;
+  bool readWaveHeader(std::string &error);
+  void releaseConsumedPages();
+
+  MappedFile file;
+  const uint8 *readPos{nullptr};
+  const uint8 *releasedPos{nullptr};
+  Encoding encoding{Encoding::kFloat32};
+  int32 numChannels{0};
+  int32 bytesPerSample{4};
+  SampleRate sampleRate{0};
+  int64 numFrames{0};
+  int64 framesLeft{0};
+};
+
+//------------------------------------------------------------------------
+/** Streaming writer for float32 WAV files, switching to RF64 when the data
+ *  exceeds 4 GB. Paths ending in ".raw" are written as headerless
+ *  interleaved float32.
+ *
+ *  write() only interleaves into one of two chunks; a background thread
+ *  writes the other one to disk, so the caller waits only if the disk
+ *  falls behind by a whole chunk.
+ */
+class AudioFileWriter {
+public:
+  using Ptr = std::unique_ptr<AudioFileWriter>;
+
+  ~AudioFileWriter();
+
+  static Ptr create(const std::string &path, int32 numChannels,
+                    SampleRate sampleRate, std::string &error);
+
+  bool write(float *const *channels, int32 numFrames);
+  bool close();
+
+private:
+  struct Chunk {
+    std::vector<float> samples;
+    int32 numFrames = 0;
+  };
+
+  AudioFileWriter() = default;
+  bool writeWaveHeader();
+  void submitChunk();
+  void writerThread();
+
+  std::FILE *file{nullptr};
+  bool isRaw{false};
+  int32 numChannels{0};
+  SampleRate sampleRate{0};
+  int64 numFrames{0};
+
+  std::array<Chunk, 2> chunks;
+  int32 chunkFrames{0};
+  //! Chunk filled by write().
+  size_t fillIndex{0};
+  //! Chunk handed to the writer thread, kNoChunk if it is idle.
+  static constexpr size_t kNoChunk = ~size_t(0);
+  size_t pendingIndex{kNoChunk};
+  bool stopping{false};
+  std::atomic<bool> failed{false};
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::thread thread;
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/offline/mappedfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+MappedFile::~MappedFile() { close(); }
+
+//------------------------------------------------------------------------
+bool MappedFile::open(const std::string &path, bool sequential,
+                      std::string &error) {
+  close();
+  auto fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    error = "Could not open " + path;
+    return false;
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    error = "Could not stat " + path;
+    return false;
+  }
+  length = static_cast<int64>(info.st_size);
+  if (length == 0) {
+    ::close(fd);
+    return true;
+  }
+
+  auto address = mmap(nullptr, static_cast<size_t>(length), PROT_READ,
+                      MAP_PRIVATE, fd, 0);
+  // the mapping keeps the file referenced
+  ::close(fd);
+  if (address == MAP_FAILED) {
+    length = 0;
+    error = "Could not map " + path;
+    return false;
+  }
+  if (sequential)
+    madvise(address, static_cast<size_t>(length), MADV_SEQUENTIAL);
+  begin = static_cast<const uint8 *>(address);
+  return true;
+}
+
+//------------------------------------------------------------------------
+void MappedFile::close() {
+  if (begin)
+    munmap(const_cast<uint8 *>(begin), static_cast<size_t>(length));
+  begin = nullptr;
+  length = 0;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
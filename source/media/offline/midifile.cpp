@@ -0,0 +1,312 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/offline/midifile.h"
+#include "source/media/miditovst.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+static const uint32 kDefaultMicrosecondsPerQuarter = 500000; // 120 BPM
+static const uint8 kMetaEvent = 0xFF;
+static const uint8 kMetaTempo = 0x51;
+static const uint8 kMetaEndOfTrack = 0x2F;
+static const uint8 kSysEx = 0xF0;
+static const uint8 kSysExEscape = 0xF7;
+
+//------------------------------------------------------------------------
+static uint16 readBE16(const uint8 *data) {
+  return static_cast<uint16>((data[0] << 8) | data[1]);
+}
+
+//------------------------------------------------------------------------
+static uint32 readBE32(const uint8 *data) {
+  return (static_cast<uint32>(data[0]) << 24) |
+         (static_cast<uint32>(data[1]) << 16) |
+         (static_cast<uint32>(data[2]) << 8) | static_cast<uint32>(data[3]);
+}
+
+//------------------------------------------------------------------------
+//! Variable length quantity of at most 4 bytes. Returns false if it runs
+//! past end or is longer.
+static bool readVarLen(const uint8 *&pos, const uint8 *end, uint32 &value) {
+  value = 0;
+  for (int i = 0; i < 4 && pos < end; ++i) {
+    auto byte = *pos++;
+    value = (value << 7) | (byte & 0x7F);
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------
+auto MidiFileReader::open(const std::string &path, SampleRate sampleRate,
+                          std::string &error) -> Ptr {
+  Ptr reader(new MidiFileReader);
+  reader->sampleRate = sampleRate;
+  if (!reader->file.open(path, true, error))
+    return nullptr;
+  if (!reader->readHeader(error)) {
+    error = path + ": " + error;
+    return nullptr;
+  }
+
+  // one pass to know the length, e.g. for rendering without audio input
+  Event event;
+  while (reader->next(event)) {
+  }
+  reader->lengthFrames = reader->tickToFrame(reader->lastTick);
+  reader->rewind();
+  return reader;
+}
+
+//------------------------------------------------------------------------
+bool MidiFileReader::readHeader(std::string &error) {
+  auto pos = file.data();
+  auto end = pos + file.size();
+  if (file.size() < 14 || std::memcmp(pos, "MThd", 4) != 0) {
+    error = "Not a Standard MIDI File";
+    return false;
+  }
+  auto headerSize = readBE32(pos + 4);
+  auto format = readBE16(pos + 8);
+  auto numTracks = readBE16(pos + 10);
+  auto division = readBE16(pos + 12);
+  if (headerSize < 6 || format > 1) {
+    error = "Unsupported MIDI file format " + std::to_string(format);
+    return false;
+  }
+  if (division & 0x8000) {
+    auto framesPerSecond = -static_cast<int8>(division >> 8);
+    auto ticksPerFrame = division & 0xFF;
+    if (framesPerSecond <= 0 || ticksPerFrame == 0) {
+      error = "Invalid SMPTE time division";
+      return false;
+    }
+    smpteSecondsPerTick = 1. / (framesPerSecond * ticksPerFrame);
+  } else {
+    ticksPerQuarter = division;
+    if (ticksPerQuarter == 0) {
+      error = "Invalid time division";
+      return false;
+    }
+  }
+
+  // locate the track chunks, other chunks are skipped
+  pos += 8 + headerSize;
+  tracks.reserve(numTracks);
+  while (end - pos >= 8 && tracks.size() < numTracks) {
+    auto chunkSize = static_cast<int64>(readBE32(pos + 4));
+    auto data = pos + 8;
+    if (chunkSize > end - data)
+      chunkSize = end - data;
+    if (std::memcmp(pos, "MTrk", 4) == 0)
+      tracks.push_back({data, data + chunkSize, data, 0, 0, false});
+    pos = data + chunkSize;
+  }
+  if (tracks.empty()) {
+    error = "No tracks";
+    return false;
+  }
+  rewind();
+  return true;
+}
+
+//------------------------------------------------------------------------
+void MidiFileReader::rewind() {
+  anchorTick = 0;
+  anchorSeconds = 0.;
+  lastTick = 0;
+  numCorruptTracks = 0;
+  setTempo(0, kDefaultMicrosecondsPerQuarter);
+  for (auto &track : tracks) {
+    track.pos = track.begin;
+    track.tick = 0;
+    track.runningStatus = 0;
+    track.ended = false;
+    readDelta(track);
+  }
+}
+
+//------------------------------------------------------------------------
+void MidiFileReader::setTempo(int64 tick, uint32 microsecondsPerQuarter) {
+  anchorSeconds += (tick - anchorTick) * secondsPerTick;
+  anchorTick = tick;
+  if (ticksPerQuarter > 0)
+    secondsPerTick = microsecondsPerQuarter * 1e-6 / ticksPerQuarter;
+  else
+    secondsPerTick = smpteSecondsPerTick;
+}
+
+//------------------------------------------------------------------------
+int64 MidiFileReader::tickToFrame(int64 tick) const {
+  auto seconds = anchorSeconds + (tick - anchorTick) * secondsPerTick;
+  return std::llround(seconds * sampleRate);
+}
+
+//------------------------------------------------------------------------
+void MidiFileReader::endTrack(Track &track, bool corrupt) {
+  track.ended = true;
+  if (corrupt)
+    ++numCorruptTracks;
+}
+
+//------------------------------------------------------------------------
+void MidiFileReader::readDelta(Track &track) {
+  if (track.pos >= track.end) {
+    endTrack(track, false);
+    return;
+  }
+  uint32 delta = 0;
+  if (!readVarLen(track.pos, track.end, delta)) {
+    endTrack(track, true);
+    return;
+  }
+  track.tick += delta;
+}
+
+//------------------------------------------------------------------------
+bool MidiFileReader::next(Event &event) {
+  for (;;) {
+    // the track with the earliest pending event, there are only a few
+    Track *track = nullptr;
+    for (auto &candidate : tracks) {
+      if (!candidate.ended && (!track || candidate.tick < track->tick))
+        track = &candidate;
+    }
+    if (!track)
+      return false;
+    if (readEvent(*track, event))
+      return true;
+  }
+}
+
+//------------------------------------------------------------------------
+bool MidiFileReader::readEvent(Track &track, Event &event) {
+  auto &pos = track.pos;
+  lastTick = std::max(lastTick, track.tick);
+  if (pos >= track.end) {
+    endTrack(track, true);
+    return false;
+  }
+
+  uint8 status = *pos;
+  if (status & 0x80)
+    ++pos;
+  else if (track.runningStatus)
+    status = track.runningStatus;
+  else {
+    endTrack(track, true);
+    return false;
+  }
+
+  uint32 length = 0;
+  if (status == kMetaEvent) {
+    if (pos >= track.end) {
+      endTrack(track, true);
+      return false;
+    }
+    auto type = *pos++;
+    if (!readVarLen(pos, track.end, length) || length > track.end - pos) {
+      endTrack(track, true);
+      return false;
+    }
+    if (type == kMetaEndOfTrack) {
+      endTrack(track, false);
+      return false;
+    }
+    if (type == kMetaTempo && length == 3) {
+      auto tempo = (static_cast<uint32>(pos[0]) << 16) |
+                   (static_cast<uint32>(pos[1]) << 8) | pos[2];
+      if (tempo > 0)
+        setTempo(track.tick, tempo);
+    }
+    pos += length;
+    track.runningStatus = 0;
+    readDelta(track);
+    return false;
+  }
+
+  if (status == kSysEx || status == kSysExEscape) {
+    if (!readVarLen(pos, track.end, length) || length > track.end - pos) {
+      endTrack(track, true);
+      return false;
+    }
+    // escapes carry arbitrary bytes, only complete messages are passed on
+    bool isMessage = status == kSysEx && length > 0;
+    if (isMessage) {
+      event.event = {};
+      event.event.type = kSysExStatus;
+      event.event.sysExData = pos;
+      event.event.sysExSize = length;
+      event.frame = tickToFrame(track.tick);
+    }
+    pos += length;
+    track.runningStatus = 0;
+    readDelta(track);
+    return isMessage;
+  }
+
+  if (status >= 0xF0) {
+    // system common and realtime messages have no place in a file
+    endTrack(track, true);
+    return false;
+  }
+
+  auto numDataBytes = midiDataLength(status);
+  if (track.end - pos < numDataBytes) {
+    endTrack(track, true);
+    return false;
+  }
+  track.runningStatus = status;
+
+  auto &midi = event.event;
+  midi = {};
+  midi.type = status & 0xF0;
+  midi.channel = status & 0x0F;
+  midi.data0 = pos[0] & 0x7F;
+  midi.data1 = numDataBytes > 1 ? pos[1] & 0x7F : 0;
+  // note on with velocity 0 is a note off in running status streams
+  if (midi.type == 0x90 && midi.data1 == 0)
+    midi.type = 0x80;
+  event.frame = tickToFrame(track.tick);
+  pos += numDataBytes;
+  readDelta(track);
+  return true;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "source/media/imediaserver.h"
+#include "source/media/offline/mappedfile.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+/** Streaming reader for Standard MIDI Files (format 0 and 1).
+ *
+ *  The file is memory mapped and the tracks are merged on the fly, so
+ *  memory use does not depend on the file length. Tick positions are
+ *  converted to sample frames through the tempo map, which is built up
+ *  from the tempo events as they are passed. Meta events are consumed
+ *  internally, next() yields channel and SysEx messages; the SysEx bytes
+ *  point into the mapped file.
+ */
+class MidiFileReader {
+public:
+  using Ptr = std::unique_ptr<MidiFileReader>;
+
+  struct Event {
+    //! timestamp is left 0, frame is the position from the file start.
+    IMidiClient::Event event;
+    int64 frame;
+  };
+
+  static Ptr open(const std::string &path, SampleRate sampleRate,
+                  std::string &error);
+
+  //! Returns the next message in time order, false at the end.
+  //! Does not allocate.
+  bool next(Event &event);
+  //! Starts over from the beginning of the file.
+  void rewind();
+
+  //! Frame of the last event or end of track, known from opening.
+  int64 getLengthFrames() const { return lengthFrames; }
+  //! Tracks that ended early on malformed data.
+  int32 getNumCorruptTracks() const { return numCorruptTracks; }
+
+private:
+  struct Track {
+    const uint8 *begin;
+    const uint8 *end;
+    const uint8 *pos;
+    int64 tick;
+    uint8 runningStatus;
+    bool ended;
+  };
+
+  MidiFileReader() = default;
+  bool readHeader(std::string &error);
+  bool readEvent(Track &track, Event &event);
+  void readDelta(Track &track);
+  void endTrack(Track &track, bool corrupt);
+  void setTempo(int64 tick, uint32 microsecondsPerQuarter);
+  int64 tickToFrame(int64 tick) const;
+
+  MappedFile file;
+  std::vector<Track> tracks;
+  SampleRate sampleRate = 0;
+  //! Ticks per quarter note, 0 for SMPTE time code.
+  int32 ticksPerQuarter = 0;
+  double smpteSecondsPerTick = 0.;
+
+  //! Tempo map state: the current tempo started at anchorTick, which is
+  //! anchorSeconds into the file.
+  int64 anchorTick = 0;
+  double anchorSeconds = 0.;
+  double secondsPerTick = 0.;
+  int64 lastTick = 0;
+
+  int64 lengthFrames = 0;
+  int32 numCorruptTracks = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
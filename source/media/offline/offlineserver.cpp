@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/offline/offlineserver.h"
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+static const SampleRate kDefaultSampleRate = 48000.;
+
+//------------------------------------------------------------------------
+static bool endsWith(const std::string &str, const std::string &suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+//------------------------------------------------------------------------
+OfflineMediaServerPtr createOfflineMediaServer(const OfflineSetup &setup,
+                                               std::string &error) {
+  auto server = std::make_shared<OfflineMediaServer>(setup);
+  if (!server->initialize(error))
+    return nullptr;
+  return server;
+}
+
+//------------------------------------------------------------------------
+OfflineMediaServer::OfflineMediaServer(const OfflineSetup &setup)
+    : setup(setup) {}
+
+//------------------------------------------------------------------------
+OfflineMediaServer::~OfflineMediaServer() = default;
+
+//------------------------------------------------------------------------
+bool OfflineMediaServer::initialize(std::string &error) {
+  if (setup.blockSize <= 0) {
+    error = "Invalid block size";
+    return false;
+  }
+
+  sampleRate = setup.sampleRate;
+  if (setup.inputPath.empty()) {
+    if (sampleRate == 0)
+      sampleRate = kDefaultSampleRate;
+    addSecondsToFrames();
+    return openMidiFile(error);
+  }
+
+  if (endsWith(setup.inputPath, ".raw"))
+    reader = AudioFileReader::openRaw(
+        setup.inputPath, setup.rawInputChannels,
+        sampleRate == 0 ? kDefaultSampleRate : sampleRate, error);
+  else
+    reader = AudioFileReader::open(setup.inputPath, error);
+  if (!reader)
+    return false;
+
+  if (sampleRate == 0)
+    sampleRate = reader->getSampleRate();
+  if (sampleRate != reader->getSampleRate()) {
+    error = "Sample rate of " + setup.inputPath +
+            " does not match the requested sample rate";
+    return false;
+  }
+  addSecondsToFrames();
+  return openMidiFile(error);
+}
+
+//------------------------------------------------------------------------
+bool OfflineMediaServer::openMidiFile(std::string &error) {
+  if (setup.midiPath.empty())
+    return true;
+  midiReader = MidiFileReader::open(setup.midiPath, sampleRate, error);
+  if (!midiReader)
+    return false;
+  if (!reader && setup.numFrames == 0)
+    setup.numFrames = midiReader->getLengthFrames();
+  return true;
+}
+
+//------------------------------------------------------------------------
+void OfflineMediaServer::deliverMidiEvents(int64 blockStart,
+                                           int32 numSamples) {
+  auto blockEnd = blockStart + numSamples;
+  while (hasPendingMidiEvent ||
+         (hasPendingMidiEvent = midiReader->next(pendingMidiEvent))) {
+    if (pendingMidiEvent.frame >= blockEnd)
+      break;
+    auto event = pendingMidiEvent.event;
+    event.timestamp = std::max<int64>(pendingMidiEvent.frame - blockStart, 0);
+    midiClient->onEvent(event, 0);
+    hasPendingMidiEvent = false;
+  }
+}
+
+//------------------------------------------------------------------------
+void OfflineMediaServer::addSecondsToFrames() {
+  setup.numFrames += std::llround(setup.durationSeconds * sampleRate);
+  setup.tailFrames += std::llround(setup.tailSeconds * sampleRate);
+}
+
+//------------------------------------------------------------------------
+void OfflineMediaServer::allocateBuffers(const IAudioClient::IOSetup &ioSetup) {
+  auto blockSize = static_cast<size_t>(setup.blockSize);
+  inputBuffers.assign(ioSetup.inputs.size(), std::vector<float>(blockSize));
+  outputBuffers.assign(ioSetup.outputs.size(), std::vector<float>(blockSize));
+
+  audioInputPointers.clear();
+  for (auto &buffer : inputBuffers)
+    audioInputPointers.push_back(buffer.data());
+  audioOutputPointers.clear();
+  for (auto &buffer : outputBuffers)
+    audioOutputPointers.push_back(buffer.data());
+
+  buffers.inputs = audioInputPointers.data();
+  buffers.numInputs = static_cast<int32_t>(audioInputPointers.size());
+  buffers.outputs = audioOutputPointers.data();
+  buffers.numOutputs = static_cast<int32_t>(audioOutputPointers.size());
+  buffers.numSamples = setup.blockSize;
+}
+
+//------------------------------------------------------------------------
+bool OfflineMediaServer::registerAudioClient(IAudioClient *client) {
+  if (audioClient)
+    return false;
+
+  audioClient = client;
+  allocateBuffers(audioClient->getIOSetup());
+
+  //! Same order as a device would announce it: the block size is prepared
+  //! once the sample rate is known.
+  if (!audioClient->setSamplerate(sampleRate))
+    return false;
+  return audioClient->setBlockSize(setup.blockSize);
+}
+
+//------------------------------------------------------------------------
+bool OfflineMediaServer::registerMidiClient(IMidiClient *client) {
+  if (midiClient)
+    return false;
+
+  midiClient = client;
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool OfflineMediaServer::run(std::string &error) {
+  if (!audioClient) {
+    error = "No audio client registered";
+    return false;
+  }
+  if (outputBuffers.empty()) {
+    error = "Audio client has no outputs";
+    return false;
+  }
+
+  auto writer = AudioFileWriter::create(
+      setup.outputPath, static_cast<int32>(outputBuffers.size()), sampleRate,
+      error);
+  if (!writer)
+    return false;
+
+  auto totalFrames = (reader ? reader->getNumFrames() : setup.numFrames) +
+                     setup.tailFrames;
+  renderedFrames = 0;
+  if (midiReader)
+    midiReader->rewind();
+  hasPendingMidiEvent = false;
+  while (renderedFrames < totalFrames) {
+    auto numSamples = static_cast<int32>(
+        std::min<int64>(setup.blockSize, totalFrames - renderedFrames));
+    buffers.numSamples = numSamples;
+
+    if (reader)
+      reader->read(buffers.inputs, buffers.numInputs, numSamples);
+    else
+      for (auto &buffer : inputBuffers)
+        std::fill(buffer.begin(), buffer.end(), 0.f);
+
+    if (midiReader && midiClient)
+      deliverMidiEvents(renderedFrames, numSamples);
+
+    if (!audioClient->process(buffers, renderedFrames)) {
+      error = "Processing failed at frame " + std::to_string(renderedFrames);
+      return false;
+    }
+
+    if (!writer->write(buffers.outputs, numSamples)) {
+      error = "Could not write to " + setup.outputPath;
+      return false;
+    }
+    renderedFrames += numSamples;
+  }
+
+  if (!writer->close()) {
+    error = "Could not finalize " + setup.outputPath;
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,119 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "source/media/imediaserver.h"
+#include "source/media/offline/audiofile.h"
+#include "source/media/offline/midifile.h"
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+struct OfflineSetup {
+  //! WAV or raw float32 input. When empty, numFrames of silence are rendered.
+  std::string inputPath;
+  //! Standard MIDI File played to the MIDI client, sample accurately. Without
+  //! audio input and duration its length sets the number of frames.
+  std::string midiPath;
+  //! float32 WAV output, or raw float32 when the path ends in ".raw".
+  std::string outputPath;
+  //! 0 takes the sample rate of the input file (48 kHz without input).
+  SampleRate sampleRate = 0;
+  int32 blockSize = 512;
+  //! Channel count of raw input files.
+  int32 rawInputChannels = 2;
+  int64 numFrames = 0;
+  //! Frames rendered after the end of the input, e.g. for reverb tails.
+  int64 tailFrames = 0;
+  //! Added to numFrames and tailFrames once the sample rate is known, which
+  //! may only be the case after opening the input.
+  double durationSeconds = 0.;
+  double tailSeconds = 0.;
+};
+
+//------------------------------------------------------------------------
+/** Media server which drives the registered IAudioClient from a file as fast
+ *  as possible instead of at the pace of an audio device.
+ */
+class OfflineMediaServer : public IMediaServer {
+public:
+  explicit OfflineMediaServer(const OfflineSetup &setup);
+  ~OfflineMediaServer() override;
+
+  // IMediaServer interface
+  bool registerAudioClient(IAudioClient *client) override;
+  bool registerMidiClient(IMidiClient *client) override;
+
+  bool initialize(std::string &error);
+
+  //! Renders the whole input into the output file. Blocks until done.
+  bool run(std::string &error);
+
+  SampleRate getSampleRate() const { return sampleRate; }
+  int64 getRenderedFrames() const { return renderedFrames; }
+
+private:
+  using ChannelBuffers = std::vector<std::vector<float>>;
+  using BufferPointers = std::vector<float *>;
+
+  void allocateBuffers(const IAudioClient::IOSetup &ioSetup);
+  void addSecondsToFrames();
+  bool openMidiFile(std::string &error);
+  void deliverMidiEvents(int64 blockStart, int32 numSamples);
+
+  OfflineSetup setup;
+  SampleRate sampleRate = 0;
+  int64 renderedFrames = 0;
+
+  IAudioClient *audioClient = nullptr;
+  IMidiClient *midiClient = nullptr;
+  AudioFileReader::Ptr reader;
+  MidiFileReader::Ptr midiReader;
+  MidiFileReader::Event pendingMidiEvent{};
+  bool hasPendingMidiEvent = false;
+
+  ChannelBuffers inputBuffers;
+  ChannelBuffers outputBuffers;
+  BufferPointers audioInputPointers;
+  BufferPointers audioOutputPointers;
+  IAudioClient::Buffers buffers{nullptr};
+};
+
+//------------------------------------------------------------------------
+using OfflineMediaServerPtr = std::shared_ptr<OfflineMediaServer>;
+
+OfflineMediaServerPtr createOfflineMediaServer(const OfflineSetup &setup,
+                                               std::string &error);
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,180 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/pluginchain.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+PluginChainPtr PluginChain::create(const Stages &stages,
+                                   const IMediaServerPtr &mediaServer) {
+  if (stages.empty())
+    return nullptr;
+  for (const auto &stage : stages) {
+    if (!stage)
+      return nullptr;
+  }
+
+  auto chain = std::make_shared<PluginChain>(stages);
+  if (!chain->attachMediaServer(mediaServer))
+    return nullptr;
+  return chain;
+}
+
+//------------------------------------------------------------------------
+PluginChain::PluginChain(const Stages &stages) : stages(stages) {
+  for (const auto &stage : stages) {
+    auto ioSetup = stage->getIOSetup();
+    numStageInputs.push_back(static_cast<int32>(ioSetup.inputs.size()));
+    numStageOutputs.push_back(static_cast<int32>(ioSetup.outputs.size()));
+  }
+}
+
+//------------------------------------------------------------------------
+bool PluginChain::attachMediaServer(const IMediaServerPtr &server) {
+  mediaServer = server;
+  if (!mediaServer)
+    return true;
+  if (!mediaServer->registerAudioClient(this))
+    return false;
+  return mediaServer->registerMidiClient(this);
+}
+
+//------------------------------------------------------------------------
+void PluginChain::allocateBuffers() {
+  auto maxChannels = std::max(
+      *std::max_element(numStageInputs.begin(), numStageInputs.end()),
+      *std::max_element(numStageOutputs.begin(), numStageOutputs.end()));
+  auto frames = static_cast<size_t>(blockSize);
+
+  for (int32 set = 0; set < 2; ++set) {
+    pingPongMemory[set].assign(frames * maxChannels, 0.f);
+    pingPong[set].resize(maxChannels);
+    for (int32 i = 0; i < maxChannels; ++i)
+      pingPong[set][i] = pingPongMemory[set].data() + i * frames;
+  }
+  silence.assign(frames, 0.f);
+  discard.assign(frames, 0.f);
+  stageInputs.resize(maxChannels);
+  stageOutputs.resize(maxChannels);
+}
+
+//------------------------------------------------------------------------
+void PluginChain::mapChannels(BufferPointers &pointers, float **source,
+                              int32 numSource, float *fallback) const {
+  for (size_t i = 0; i < pointers.size(); ++i)
+    pointers[i] = static_cast<int32>(i) < numSource ? source[i] : fallback;
+}
+
+//------------------------------------------------------------------------
+bool PluginChain::process(Buffers &buffers, int64_t continousFrames) {
+  if (buffers.numSamples > blockSize)
+    return false;
+
+  float **previousOutputs = buffers.inputs;
+  int32 numPreviousOutputs = buffers.numInputs;
+  auto lastStage = static_cast<int32>(stages.size()) - 1;
+  bool result = true;
+  for (int32 index = 0; index <= lastStage; ++index) {
+    //! An earlier stage may have written to the silence it read.
+    if (numPreviousOutputs < numStageInputs[index])
+      std::fill_n(silence.data(), buffers.numSamples, 0.f);
+    mapChannels(stageInputs, previousOutputs, numPreviousOutputs,
+                silence.data());
+
+    Buffers stageBuffers = buffers;
+    stageBuffers.inputs = stageInputs.data();
+    stageBuffers.numInputs = numStageInputs[index];
+    if (index == lastStage) {
+      mapChannels(stageOutputs, buffers.outputs, buffers.numOutputs,
+                  discard.data());
+    } else {
+      auto &target = pingPong[index % 2];
+      mapChannels(stageOutputs, target.data(), numStageOutputs[index],
+                  discard.data());
+    }
+    stageBuffers.outputs = stageOutputs.data();
+    stageBuffers.numOutputs = numStageOutputs[index];
+
+    result &= stages[index]->process(stageBuffers, continousFrames);
+
+    previousOutputs = pingPong[index % 2].data();
+    numPreviousOutputs = numStageOutputs[index];
+  }
+
+  for (int32 i = numStageOutputs[lastStage]; i < buffers.numOutputs; ++i)
+    std::fill_n(buffers.outputs[i], buffers.numSamples, 0.f);
+
+  return result;
+}
+
+//------------------------------------------------------------------------
+bool PluginChain::setSamplerate(SampleRate value) {
+  bool result = true;
+  for (auto &stage : stages)
+    result &= stage->setSamplerate(value);
+  return result;
+}
+
+//------------------------------------------------------------------------
+bool PluginChain::setBlockSize(int32 value) {
+  blockSize = value;
+  allocateBuffers();
+
+  bool result = true;
+  for (auto &stage : stages)
+    result &= stage->setBlockSize(value);
+  return result;
+}
+
+//------------------------------------------------------------------------
+IAudioClient::IOSetup PluginChain::getIOSetup() const {
+  IAudioClient::IOSetup ioSetup;
+  ioSetup.inputs = stages.front()->getIOSetup().inputs;
+  ioSetup.outputs = stages.back()->getIOSetup().outputs;
+  return ioSetup;
+}
+
+//------------------------------------------------------------------------
+bool PluginChain::onEvent(const Event &event, int32_t port) {
+  return stages.front()->onEvent(event, port);
+}
+
+//------------------------------------------------------------------------
+IMidiClient::IOSetup PluginChain::getMidiIOSetup() const {
+  return stages.front()->getMidiIOSetup();
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
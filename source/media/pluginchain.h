@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "source/media/audioclient.h"
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+using PluginChainPtr = std::shared_ptr<class PluginChain>;
+//------------------------------------------------------------------------
+/** Runs several AudioClients in series inside one media server client.
+ *
+ *  The first stage reads the server inputs and receives all MIDI, the last
+ *  stage writes the server outputs. Stages in between exchange audio
+ *  through two preallocated ping-pong buffer sets: stage n writes the set
+ *  stage n + 1 reads, so nothing is copied. Missing input channels read
+ *  silence and surplus output channels are discarded.
+ */
+class PluginChain : public IAudioClient, public IMidiClient {
+public:
+  //--------------------------------------------------------------------
+  using Stages = std::vector<AudioClientPtr>;
+
+  //! stages must have been created without a media server.
+  static PluginChainPtr create(const Stages &stages,
+                               const IMediaServerPtr &mediaServer);
+
+  PluginChain(const Stages &stages);
+
+  // IAudioClient
+  bool process(Buffers &buffers, int64_t continousFrames) override;
+  bool setSamplerate(SampleRate value) override;
+  bool setBlockSize(int32 value) override;
+  IAudioClient::IOSetup getIOSetup() const override;
+
+  // IMidiClient
+  bool onEvent(const Event &event, int32_t port) override;
+  IMidiClient::IOSetup getMidiIOSetup() const override;
+
+  const Stages &getStages() const { return stages; }
+
+  //--------------------------------------------------------------------
+private:
+  using BufferPointers = std::vector<float *>;
+
+  bool attachMediaServer(const IMediaServerPtr &server);
+  void allocateBuffers();
+  void mapChannels(BufferPointers &pointers, float **source,
+                   int32 numSource, float *fallback) const;
+
+  Stages stages;
+  IMediaServerPtr mediaServer;
+  int32 blockSize = 0;
+
+  //! Channel counts of every stage, taken from getIOSetup once.
+  std::vector<int32> numStageInputs;
+  std::vector<int32> numStageOutputs;
+
+  //! Ping-pong sets, each holding the widest stage output.
+  std::vector<float> pingPongMemory[2];
+  BufferPointers pingPong[2];
+  std::vector<float> silence;
+  std::vector<float> discard;
+
+  //! Per block channel pointers handed to a stage.
+  BufferPointers stageInputs;
+  BufferPointers stageOutputs;
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,377 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/processgraph.h"
+
+#include <algorithm>
+#include <cerrno>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+//------------------------------------------------------------------------
+ProcessGraph::ProcessGraph() {}
+
+//------------------------------------------------------------------------
+ProcessGraph::~ProcessGraph() {
+  //! Stops the server callbacks before the workers go away.
+  mediaServer = nullptr;
+  stopWorkers();
+}
+
+//------------------------------------------------------------------------
+auto ProcessGraph::addNode(const AudioClientNode &client,
+                           IMidiClient *midiClient) -> NodeID {
+  Node node;
+  node.client = client;
+  node.midiClient = midiClient;
+  nodes.push_back(std::move(node));
+  return static_cast<NodeID>(nodes.size()) - 1;
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::connect(NodeID from, NodeID to) {
+  auto numNodes = static_cast<NodeID>(nodes.size());
+  if (from < 0 || from >= numNodes || to < 0 || to >= numNodes || from == to)
+    return false;
+
+  nodes[from].outputs.push_back(to);
+  nodes[to].inputs.push_back(from);
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::sortNodes(std::string &error) {
+  //! Kahn's algorithm, only to reject cycles. The execution order is
+  //! resolved at runtime from the pending input counts.
+  std::vector<size_t> numInputs(nodes.size());
+  NodeIDs ready;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    numInputs[i] = nodes[i].inputs.size();
+    if (numInputs[i] == 0)
+      ready.push_back(static_cast<NodeID>(i));
+  }
+  sources = ready;
+
+  size_t numSorted = 0;
+  while (!ready.empty()) {
+    auto node = ready.back();
+    ready.pop_back();
+    ++numSorted;
+    for (auto output : nodes[node].outputs) {
+      if (--numInputs[output] == 0)
+        ready.push_back(output);
+    }
+  }
+  if (numSorted != nodes.size()) {
+    error = "The process graph contains a cycle";
+    return false;
+  }
+
+  sinks.clear();
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].outputs.empty())
+      sinks.push_back(static_cast<NodeID>(i));
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::start(const IMediaServerPtr &server, int32 numWorkers,
+                         const RealtimeOptions &options, std::string &error) {
+  if (nodes.empty()) {
+    error = "The process graph is empty";
+    return false;
+  }
+  if (!sortNodes(error))
+    return false;
+
+  for (auto &node : nodes)
+    node.ioSetup = node.client->getIOSetup();
+
+  pendingInputs.reset(new std::atomic<int32>[nodes.size()]);
+
+  for (int32 index = 0; index <= std::max(numWorkers, 0); ++index) {
+    auto worker = std::make_unique<Worker>();
+    worker->deque.reset(nodes.size());
+    sem_init(&worker->wakeUp, 0, 0);
+    workers.push_back(std::move(worker));
+  }
+  for (int32 index = 1; index < static_cast<int32>(workers.size()); ++index) {
+    auto &worker = *workers[index];
+    worker.thread = std::thread([this, index]() { workerThread(index); });
+    if (!configureRealtimeThread(worker.thread.native_handle(), options,
+                                 error))
+      return false;
+  }
+
+  mediaServer = server;
+  if (!mediaServer)
+    return true;
+  if (!mediaServer->registerAudioClient(this)) {
+    error = "Could not register the process graph";
+    return false;
+  }
+  return mediaServer->registerMidiClient(this);
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::stopWorkers() {
+  stopping.store(true);
+  for (size_t index = 1; index < workers.size(); ++index)
+    sem_post(&workers[index]->wakeUp);
+  for (auto &worker : workers) {
+    if (worker->thread.joinable())
+      worker->thread.join();
+    sem_destroy(&worker->wakeUp);
+  }
+  workers.clear();
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::workerThread(int32 index) {
+  auto &worker = *workers[index];
+  while (true) {
+    if (sem_wait(&worker.wakeUp) != 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    if (stopping.load())
+      return;
+
+    runNodes(index);
+    busyWorkers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::findWork(int32 workerIndex, NodeID &node) {
+  if (workers[workerIndex]->deque.pop(node))
+    return true;
+
+  auto numWorkers = static_cast<int32>(workers.size());
+  for (int32 i = 1; i < numWorkers; ++i) {
+    auto victim = (workerIndex + i) % numWorkers;
+    if (workers[victim]->deque.steal(node))
+      return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::runNodes(int32 workerIndex) {
+  while (remainingNodes.load(std::memory_order_acquire) > 0) {
+    NodeID node;
+    if (findWork(workerIndex, node))
+      processNode(node, workerIndex);
+    else
+      cpuRelax();
+  }
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::mixInputs(Node &node) {
+  auto numSamples = periodBuffers->numSamples;
+  for (size_t channel = 0; channel < node.inputBuffers.size(); ++channel) {
+    auto *target = node.inputBuffers[channel];
+    std::fill_n(target, numSamples, 0.f);
+    for (auto input : node.inputs) {
+      const auto &source = nodes[input].outputBuffers;
+      if (channel >= source.size())
+        continue;
+      for (int32 i = 0; i < numSamples; ++i)
+        target[i] += source[channel][i];
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::processNode(NodeID index, int32 workerIndex) {
+  auto &node = nodes[index];
+  auto buffers = *periodBuffers;
+  if (node.inputs.size() == 1) {
+    auto &source = nodes[node.inputs.front()].outputBuffers;
+    buffers.inputs = source.data();
+    buffers.numInputs = static_cast<int32>(source.size());
+  } else if (!node.inputs.empty()) {
+    mixInputs(node);
+    buffers.inputs = node.inputBuffers.data();
+    buffers.numInputs = static_cast<int32>(node.inputBuffers.size());
+  }
+  buffers.outputs = node.outputBuffers.data();
+  buffers.numOutputs = static_cast<int32>(node.outputBuffers.size());
+
+  if (!node.client->process(buffers, periodFrames))
+    periodFailed.store(true, std::memory_order_relaxed);
+
+  for (auto output : node.outputs) {
+    if (pendingInputs[output].fetch_sub(1, std::memory_order_acq_rel) == 1)
+      workers[workerIndex]->deque.push(output);
+  }
+  remainingNodes.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::mixOutputs(Buffers &buffers) {
+  for (int32 channel = 0; channel < buffers.numOutputs; ++channel) {
+    auto *target = buffers.outputs[channel];
+    std::fill_n(target, buffers.numSamples, 0.f);
+    for (auto sink : sinks) {
+      const auto &source = nodes[sink].outputBuffers;
+      if (channel >= static_cast<int32>(source.size()))
+        continue;
+      for (int32 i = 0; i < buffers.numSamples; ++i)
+        target[i] += source[channel][i];
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::process(Buffers &buffers, int64_t continousFrames) {
+  if (workers.empty() || buffers.numSamples > blockSize)
+    return false;
+
+  periodBuffers = &buffers;
+  periodFrames = continousFrames;
+  periodFailed.store(false, std::memory_order_relaxed);
+  for (size_t i = 0; i < nodes.size(); ++i)
+    pendingInputs[i].store(static_cast<int32>(nodes[i].inputs.size()),
+                           std::memory_order_relaxed);
+  remainingNodes.store(static_cast<int32>(nodes.size()),
+                       std::memory_order_relaxed);
+  for (auto source : sources)
+    workers[0]->deque.push(source);
+
+  auto numHelpers = static_cast<int32>(workers.size()) - 1;
+  busyWorkers.store(numHelpers, std::memory_order_release);
+  for (int32 index = 1; index <= numHelpers; ++index)
+    sem_post(&workers[index]->wakeUp);
+
+  runNodes(0);
+  while (busyWorkers.load(std::memory_order_acquire) > 0)
+    cpuRelax();
+
+  mixOutputs(buffers);
+  periodBuffers = nullptr;
+  return !periodFailed.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------
+void ProcessGraph::allocateBuffers() {
+  auto frames = static_cast<size_t>(blockSize);
+  for (auto &node : nodes) {
+    auto numOutputs = node.ioSetup.outputs.size();
+    node.outputMemory.assign(frames * numOutputs, 0.f);
+    node.outputBuffers.resize(numOutputs);
+    for (size_t i = 0; i < numOutputs; ++i)
+      node.outputBuffers[i] = node.outputMemory.data() + i * frames;
+  }
+
+  for (auto &node : nodes) {
+    size_t numInputs = 0;
+    if (node.inputs.size() > 1) {
+      for (auto input : node.inputs)
+        numInputs = std::max(numInputs, nodes[input].outputBuffers.size());
+    }
+    node.mixMemory.assign(frames * numInputs, 0.f);
+    node.inputBuffers.resize(numInputs);
+    for (size_t i = 0; i < numInputs; ++i)
+      node.inputBuffers[i] = node.mixMemory.data() + i * frames;
+  }
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::setSamplerate(SampleRate value) {
+  bool result = true;
+  for (auto &node : nodes)
+    result &= node.client->setSamplerate(value);
+  return result;
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::setBlockSize(int32 value) {
+  blockSize = value;
+  allocateBuffers();
+
+  bool result = true;
+  for (auto &node : nodes)
+    result &= node.client->setBlockSize(value);
+  return result;
+}
+
+//------------------------------------------------------------------------
+IAudioClient::IOSetup ProcessGraph::getIOSetup() const {
+  IAudioClient::IOSetup ioSetup;
+  for (auto source : sources) {
+    if (nodes[source].ioSetup.inputs.size() > ioSetup.inputs.size())
+      ioSetup.inputs = nodes[source].ioSetup.inputs;
+  }
+  for (auto sink : sinks) {
+    if (nodes[sink].ioSetup.outputs.size() > ioSetup.outputs.size())
+      ioSetup.outputs = nodes[sink].ioSetup.outputs;
+  }
+  return ioSetup;
+}
+
+//------------------------------------------------------------------------
+bool ProcessGraph::onEvent(const Event &event, int32_t port) {
+  bool result = true;
+  for (auto source : sources) {
+    if (auto *midiClient = nodes[source].midiClient)
+      result &= midiClient->onEvent(event, port);
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------
+IMidiClient::IOSetup ProcessGraph::getMidiIOSetup() const {
+  IMidiClient::IOSetup ioSetup;
+  for (auto source : sources) {
+    auto *midiClient = nodes[source].midiClient;
+    if (!midiClient)
+      continue;
+    auto sourceSetup = midiClient->getMidiIOSetup();
+    if (sourceSetup.inputs.size() > ioSetup.inputs.size())
+      ioSetup = std::move(sourceSetup);
+  }
+  return ioSetup;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "source/media/imediaserver.h"
+#include "source/media/realtime.h"
+#include "source/media/workstealingdeque.h"
+#include <atomic>
+#include <semaphore.h>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+using ProcessGraphPtr = std::shared_ptr<class ProcessGraph>;
+//------------------------------------------------------------------------
+/** Runs a directed acyclic graph of audio clients on several cores.
+ *
+ *  Nodes without inputs read the server inputs and receive all MIDI, the
+ *  outputs of nodes without successors are summed into the server outputs.
+ *  A node with one predecessor reads its outputs directly, several are
+ *  summed first.
+ *
+ *  Each period, nodes whose predecessors are done are dispatched to
+ *  pre-spawned worker threads through work-stealing deques. The server
+ *  thread works too and returns from process() only after every node ran
+ *  and every worker is idle again.
+ */
+class ProcessGraph : public IAudioClient, public IMidiClient {
+public:
+  //--------------------------------------------------------------------
+  using NodeID = int32;
+  using AudioClientNode = std::shared_ptr<IAudioClient>;
+
+  ProcessGraph();
+  ~ProcessGraph() override;
+
+  //! midiClient may be null. Only before start().
+  NodeID addNode(const AudioClientNode &client, IMidiClient *midiClient);
+  //! The outputs of from feed the inputs of to. Only before start().
+  bool connect(NodeID from, NodeID to);
+
+  //! Sorts the graph, spawns numWorkers threads configured with options
+  //! and registers with server.
+  bool start(const IMediaServerPtr &server, int32 numWorkers,
+             const RealtimeOptions &options, std::string &error);
+
+  // IAudioClient
+  bool process(Buffers &buffers, int64_t continousFrames) override;
+  bool setSamplerate(SampleRate value) override;
+  bool setBlockSize(int32 value) override;
+  IAudioClient::IOSetup getIOSetup() const override;
+
+  // IMidiClient
+  bool onEvent(const Event &event, int32_t port) override;
+  IMidiClient::IOSetup getMidiIOSetup() const override;
+
+  //--------------------------------------------------------------------
+private:
+  using BufferPointers = std::vector<float *>;
+  using NodeIDs = std::vector<NodeID>;
+
+  struct Node {
+    AudioClientNode client;
+    IMidiClient *midiClient = nullptr;
+    NodeIDs inputs;
+    NodeIDs outputs;
+    IAudioClient::IOSetup ioSetup;
+
+    std::vector<float> outputMemory;
+    BufferPointers outputBuffers;
+    std::vector<float> mixMemory;
+    BufferPointers inputBuffers;
+  };
+
+  struct alignas(64) Worker {
+    std::thread thread;
+    sem_t wakeUp;
+    WorkStealingDeque<NodeID> deque;
+  };
+
+  bool sortNodes(std::string &error);
+  void allocateBuffers();
+  void stopWorkers();
+  void workerThread(int32 index);
+  void runNodes(int32 workerIndex);
+  bool findWork(int32 workerIndex, NodeID &node);
+  void processNode(NodeID node, int32 workerIndex);
+  void mixInputs(Node &node);
+  void mixOutputs(Buffers &buffers);
+
+  std::vector<Node> nodes;
+  NodeIDs sources;
+  NodeIDs sinks;
+  IMediaServerPtr mediaServer;
+  int32 blockSize = 0;
+
+  //! Index 0 belongs to the server thread.
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<bool> stopping{false};
+
+  // state of the current period
+  std::unique_ptr<std::atomic<int32>[]> pendingInputs;
+  alignas(64) std::atomic<int32> remainingNodes{0};
+  alignas(64) std::atomic<int32> busyWorkers{0};
+  Buffers *periodBuffers = nullptr;
+  int64_t periodFrames = 0;
+  std::atomic<bool> periodFailed{false};
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
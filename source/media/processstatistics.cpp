@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/processstatistics.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+ProcessStatistics::ProcessStatistics() {
+  for (auto &counter : counts)
+    counter.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------
+int32 ProcessStatistics::bucketIndex(uint64 value) {
+  if (value < kSubBuckets)
+    return static_cast<int32>(value);
+
+  auto magnitude = 63 - __builtin_clzll(value) - kSubBucketBits + 1;
+  magnitude = std::min(magnitude, kMagnitudes);
+  auto subBucket =
+      static_cast<int32>(value >> (magnitude - 1)) & (kSubBuckets - 1);
+  if (value >> (magnitude + kSubBucketBits - 1) > 1)
+    subBucket = kSubBuckets - 1; // clamped
+  return magnitude * kSubBuckets + subBucket;
+}
+
+//------------------------------------------------------------------------
+uint64 ProcessStatistics::bucketValue(int32 index) {
+  auto magnitude = index / kSubBuckets;
+  auto subBucket = static_cast<uint64>(index % kSubBuckets);
+  if (magnitude == 0)
+    return subBucket;
+  // upper bound of the bucket, so percentiles never under-report
+  return ((kSubBuckets + subBucket + 1) << (magnitude - 1)) - 1;
+}
+
+//------------------------------------------------------------------------
+void ProcessStatistics::record(int64 durationNs, int64 budgetNs) {
+  durationNs = std::max<int64>(durationNs, 0);
+
+  auto &counter = counts[bucketIndex(static_cast<uint64>(durationNs))];
+  counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+
+  auto load = budgetNs > 0 ? durationNs * 10000 / budgetNs : 0;
+  if (resetMaxRequested.exchange(false, std::memory_order_acquire)) {
+    maxDuration.store(durationNs, std::memory_order_relaxed);
+    maxLoadPermyriad.store(load, std::memory_order_relaxed);
+  } else {
+    if (durationNs > maxDuration.load(std::memory_order_relaxed))
+      maxDuration.store(durationNs, std::memory_order_relaxed);
+    if (load > maxLoadPermyriad.load(std::memory_order_relaxed))
+      maxLoadPermyriad.store(load, std::memory_order_relaxed);
+  }
+  lastBudget.store(budgetNs, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------
+void ProcessStatistics::recordRealtimeViolations(uint64 allocations,
+                                                 uint64 deallocations,
+                                                 uint64 locks) {
+  auto calls = allocations + deallocations + locks;
+  if (calls == 0)
+    return;
+
+  auto add = [](std::atomic<uint64> &counter, uint64 value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  };
+  add(rtUnsafeBlocks, 1);
+  add(rtAllocations, allocations);
+  add(rtDeallocations, deallocations);
+  add(rtLocks, locks);
+  if (calls > rtMaxCallsPerBlock.load(std::memory_order_relaxed))
+    rtMaxCallsPerBlock.store(calls, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------
+void ProcessStatistics::recordPageFaults(uint64 faults) {
+  if (faults == 0)
+    return;
+
+  pageFaults.store(pageFaults.load(std::memory_order_relaxed) + faults,
+                   std::memory_order_relaxed);
+  if (faults > maxPageFaultsPerBlock.load(std::memory_order_relaxed))
+    maxPageFaultsPerBlock.store(faults, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------
+auto ProcessStatistics::snapshot() -> Snapshot {
+  Counts interval;
+  uint64 numBlocks = 0;
+  for (int32 i = 0; i < kNumBuckets; ++i) {
+    auto current = counts[i].load(std::memory_order_relaxed);
+    interval[i] = current - lastCounts[i];
+    lastCounts[i] = current;
+    numBlocks += interval[i];
+  }
+
+  Snapshot result;
+  result.numBlocks = numBlocks;
+  result.max = maxDuration.load(std::memory_order_relaxed) / 1000.;
+  result.maxLoad = maxLoadPermyriad.load(std::memory_order_relaxed) / 10000.;
+  result.budget = lastBudget.load(std::memory_order_relaxed) / 1000.;
+  result.droppedParameterChanges =
+      droppedParameterChanges.load(std::memory_order_relaxed);
+  result.droppedEvents = droppedEvents.load(std::memory_order_relaxed);
+  result.rtUnsafeBlocks = rtUnsafeBlocks.load(std::memory_order_relaxed);
+  result.rtAllocations = rtAllocations.load(std::memory_order_relaxed);
+  result.rtDeallocations = rtDeallocations.load(std::memory_order_relaxed);
+  result.rtLocks = rtLocks.load(std::memory_order_relaxed);
+  result.rtMaxCallsPerBlock =
+      rtMaxCallsPerBlock.load(std::memory_order_relaxed);
+  result.pageFaults = pageFaults.load(std::memory_order_relaxed);
+  result.maxPageFaultsPerBlock =
+      maxPageFaultsPerBlock.load(std::memory_order_relaxed);
+  resetMaxRequested.store(true, std::memory_order_release);
+  if (numBlocks == 0)
+    return result;
+
+  auto percentile = [&](double fraction) {
+    auto threshold = static_cast<uint64>(fraction * numBlocks);
+    uint64 count = 0;
+    for (int32 i = 0; i < kNumBuckets; ++i) {
+      count += interval[i];
+      if (count > threshold)
+        return std::min(bucketValue(i) / 1000., result.max);
+    }
+    return result.max;
+  };
+  result.p50 = percentile(0.5);
+  result.p99 = percentile(0.99);
+  result.p999 = percentile(0.999);
+  return result;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
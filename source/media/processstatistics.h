@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pluginterfaces/vst/vsttypes.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+/** Log-linear (HDR style) histogram of process() durations.
+ *
+ *  record() is called by the audio thread only and neither locks nor
+ *  allocates. snapshot() is called by a single non realtime thread and
+ *  reports the blocks recorded since the previous snapshot.
+ */
+class ProcessStatistics {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Snapshot {
+    uint64 numBlocks = 0;
+    //! durations in microseconds of the blocks since the previous snapshot
+    double p50 = 0.;
+    double p99 = 0.;
+    double p999 = 0.;
+    double max = 0.;
+    //! numSamples / sampleRate of the last block in microseconds
+    double budget = 0.;
+    //! max of duration / budget since the previous snapshot
+    double maxLoad = 0.;
+    //! totals since creation, see countDropped*()
+    uint64 droppedParameterChanges = 0;
+    uint64 droppedEvents = 0;
+    //! totals since creation, see recordRealtimeViolations()
+    uint64 rtUnsafeBlocks = 0;
+    uint64 rtAllocations = 0;
+    uint64 rtDeallocations = 0;
+    uint64 rtLocks = 0;
+    uint64 rtMaxCallsPerBlock = 0;
+    //! totals since creation, see recordPageFaults()
+    uint64 pageFaults = 0;
+    uint64 maxPageFaultsPerBlock = 0;
+  };
+
+  ProcessStatistics();
+
+  void record(int64 durationNs, int64 budgetNs);
+  Snapshot snapshot();
+
+  //! Called by the producer threads of the parameter and event queues when
+  //! a queue is full, and by the audio thread for events that did not fit
+  //! into a block or output parameter changes the UI thread did not fetch
+  //! in time.
+  void countDroppedParameterChange() {
+    droppedParameterChanges.fetch_add(1, std::memory_order_relaxed);
+  }
+  void countDroppedEvent() {
+    droppedEvents.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //! Allocations, deallocations and locks a block made on the audio thread
+  //! (see RTGuard), called by the audio thread.
+  void recordRealtimeViolations(uint64 allocations, uint64 deallocations,
+                                uint64 locks);
+
+  //! Page faults the audio thread took during a block, called by the audio
+  //! thread.
+  void recordPageFaults(uint64 faults);
+
+private:
+  //! 16 sub buckets per power of two keep the relative error below 6.25%.
+  static constexpr int32 kSubBucketBits = 4;
+  static constexpr int32 kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int32 kMagnitudes = 40; // up to ~18 minutes
+  static constexpr int32 kNumBuckets = (kMagnitudes + 1) * kSubBuckets;
+
+  using Counter = std::atomic<uint64>;
+  using Counts = std::array<uint64, kNumBuckets>;
+
+  static int32 bucketIndex(uint64 value);
+  static uint64 bucketValue(int32 index);
+
+  // written by the audio thread
+  std::array<Counter, kNumBuckets> counts;
+  std::atomic<int64> maxDuration{0};
+  std::atomic<int64> maxLoadPermyriad{0};
+  std::atomic<int64> lastBudget{0};
+  std::atomic<bool> resetMaxRequested{false};
+  std::atomic<uint64> rtUnsafeBlocks{0};
+  std::atomic<uint64> rtAllocations{0};
+  std::atomic<uint64> rtDeallocations{0};
+  std::atomic<uint64> rtLocks{0};
+  std::atomic<uint64> rtMaxCallsPerBlock{0};
+  std::atomic<uint64> pageFaults{0};
+  std::atomic<uint64> maxPageFaultsPerBlock{0};
+
+  // written by the producer threads
+  std::atomic<uint64> droppedParameterChanges{0};
+  std::atomic<uint64> droppedEvents{0};
+
+  // owned by the snapshot thread
+  Counts lastCounts{};
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
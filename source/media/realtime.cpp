@@ -0,0 +1,179 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/realtime.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+static void prefaultHeap(size_t bytes) {
+  //! Keep freed memory in the heap instead of returning it to the system,
+  //! and serve large blocks from the heap instead of fresh mmaps. Threads
+  //! would otherwise get their own arenas, which the loop below does not
+  //! touch, so all of them share the main one.
+  mallopt(M_TRIM_THRESHOLD, -1);
+  mallopt(M_MMAP_MAX, 0);
+  mallopt(M_ARENA_MAX, 1);
+
+  auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  auto *block = static_cast<volatile char *>(std::malloc(bytes));
+  if (!block)
+    return;
+  for (size_t i = 0; i < bytes; i += pageSize)
+    block[i] = 0;
+  std::free(const_cast<char *>(block));
+}
+
+//------------------------------------------------------------------------
+bool lockProcessMemory(const RealtimeOptions &options, std::string &error) {
+  if (options.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    error = std::string("mlockall failed: ") + std::strerror(errno);
+    return false;
+  }
+  if (options.prefaultHeapBytes > 0)
+    prefaultHeap(options.prefaultHeapBytes);
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool configureRealtimeThread(pthread_t thread, const RealtimeOptions &options,
+                             std::string &error) {
+  if (!options.cpus.empty()) {
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (auto cpu : options.cpus)
+      CPU_SET(cpu, &cpuSet);
+    auto result = pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet);
+    if (result != 0) {
+      error = std::string("Could not pin thread: ") + std::strerror(result);
+      return false;
+    }
+  }
+
+  if (options.priority > 0) {
+    sched_param param{};
+    param.sched_priority = options.priority;
+    auto result = pthread_setschedparam(thread, SCHED_FIFO, &param);
+    if (result != 0) {
+      error = std::string("Could not set SCHED_FIFO priority: ") +
+              std::strerror(result);
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+std::string describeThreadScheduling(pthread_t thread) {
+  int policy = 0;
+  sched_param param{};
+  if (pthread_getschedparam(thread, &policy, &param) != 0)
+    return "unknown scheduling";
+
+  std::string result;
+  switch (policy) {
+  case SCHED_FIFO:
+    result = "SCHED_FIFO";
+    break;
+  case SCHED_RR:
+    result = "SCHED_RR";
+    break;
+  case SCHED_OTHER:
+    result = "SCHED_OTHER";
+    break;
+  default:
+    result = "policy " + std::to_string(policy);
+    break;
+  }
+  result += " priority " + std::to_string(param.sched_priority);
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  if (pthread_getaffinity_np(thread, sizeof(cpuSet), &cpuSet) == 0) {
+    std::string cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (!CPU_ISSET(cpu, &cpuSet))
+        continue;
+      cpus += cpus.empty() ? "" : ",";
+      cpus += std::to_string(cpu);
+    }
+    result += ", cpus " + cpus;
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------
+int64 currentThreadPageFaults() {
+  rusage usage;
+  if (getrusage(RUSAGE_THREAD, &usage) != 0)
+    return 0;
+  return static_cast<int64>(usage.ru_minflt) + usage.ru_majflt;
+}
+
+//------------------------------------------------------------------------
+bool parseCpuList(const std::string &text, std::vector<int32> &cpus) {
+  cpus.clear();
+  const char *pos = text.data();
+  while (*pos) {
+    char *end = nullptr;
+    auto first = std::strtol(pos, &end, 10);
+    if (end == pos || first < 0 || first >= CPU_SETSIZE)
+      return false;
+    auto last = first;
+    pos = end;
+    if (*pos == '-') {
+      last = std::strtol(++pos, &end, 10);
+      if (end == pos || last < first || last >= CPU_SETSIZE)
+        return false;
+      pos = end;
+    }
+    for (auto cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(static_cast<int32>(cpu));
+    if (*pos == ',')
+      ++pos;
+    else if (*pos)
+      return false;
+  }
+  return !cpus.empty();
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pluginterfaces/vst/vsttypes.h"
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+struct RealtimeOptions {
+  //! mlockall(MCL_CURRENT | MCL_FUTURE) before processing starts.
+  bool lockMemory = false;
+  //! Bytes of heap touched up front and kept by malloc afterwards, so
+  //! plug-in allocations do not page fault later. Limits malloc to a
+  //! single arena, so allocations from the processing threads use it too.
+  size_t prefaultHeapBytes = 0;
+  //! CPUs the processing threads are pinned to, empty for no pinning.
+  std::vector<int32> cpus;
+  //! SCHED_FIFO priority of the processing thread, 0 keeps the server's.
+  int32 priority = 0;
+};
+
+//------------------------------------------------------------------------
+//! Locks memory and prefaults the heap as requested by options.
+bool lockProcessMemory(const RealtimeOptions &options, std::string &error);
+
+//! Applies options.cpus and options.priority to thread.
+bool configureRealtimeThread(pthread_t thread, const RealtimeOptions &options,
+                             std::string &error);
+
+//! E.g. "SCHED_FIFO priority 70, cpus 2,3".
+std::string describeThreadScheduling(pthread_t thread);
+
+//! Minor plus major page faults of the calling thread so far.
+int64 currentThreadPageFaults();
+
+//! Parses a CPU list like "2,3" or "0-3,6".
+bool parseCpuList(const std::string &text, std::vector<int32> &cpus);
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,213 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/rtguard.h"
+
+#if MIN_VST_HOST_RT_GUARD
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+namespace RTGuard {
+
+//! Plain pointer, so accessing it from the hooks never allocates.
+static thread_local Counters *currentCounters = nullptr;
+
+//------------------------------------------------------------------------
+Scope::Scope(Counters &counters) : previous(currentCounters) {
+  counters = {};
+  currentCounters = &counters;
+}
+
+//------------------------------------------------------------------------
+Scope::~Scope() { currentCounters = previous; }
+
+#if MIN_VST_HOST_RT_GUARD
+//------------------------------------------------------------------------
+static std::atomic<uint32> remainingBacktraces{0};
+static thread_local bool inBacktrace = false;
+
+//------------------------------------------------------------------------
+static void writeBacktrace(const char *what) {
+  if (inBacktrace ||
+      remainingBacktraces.load(std::memory_order_relaxed) == 0)
+    return;
+  if (remainingBacktraces.fetch_sub(1, std::memory_order_relaxed) == 0)
+    return;
+
+  inBacktrace = true;
+  void *frames[32];
+  auto numFrames = backtrace(frames, 32);
+  ::write(STDERR_FILENO, what, __builtin_strlen(what));
+  backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+  inBacktrace = false;
+}
+
+//------------------------------------------------------------------------
+static inline void countAllocation() {
+  if (auto counters = currentCounters) {
+    ++counters->allocations;
+    writeBacktrace("[rtguard] allocation on the audio thread:\n");
+  }
+}
+
+//------------------------------------------------------------------------
+static inline void countDeallocation(void *ptr) {
+  if (!ptr)
+    return;
+  if (auto counters = currentCounters) {
+    ++counters->deallocations;
+    writeBacktrace("[rtguard] deallocation on the audio thread:\n");
+  }
+}
+
+//------------------------------------------------------------------------
+static inline void countLock() {
+  if (auto counters = currentCounters) {
+    ++counters->locks;
+    writeBacktrace("[rtguard] mutex lock on the audio thread:\n");
+  }
+}
+
+//------------------------------------------------------------------------
+bool isAvailable() { return true; }
+
+//------------------------------------------------------------------------
+void enableBacktraces(uint32 maxCount) {
+  //! The first backtrace() loads libgcc, which must not happen in a hook.
+  void *frame;
+  backtrace(&frame, 1);
+  remainingBacktraces.store(maxCount, std::memory_order_relaxed);
+}
+
+#else
+//------------------------------------------------------------------------
+bool isAvailable() { return false; }
+
+//------------------------------------------------------------------------
+void enableBacktraces(uint32) {}
+#endif
+
+//------------------------------------------------------------------------
+} // namespace RTGuard
+} // namespace Vst
+} // namespace Steinberg
+
+#if MIN_VST_HOST_RT_GUARD
+//------------------------------------------------------------------------
+// Interposed functions. The executable's definitions take precedence over
+// the C library for the host and every plug-in loaded later, as long as
+// they are exported (the SDK builds with hidden visibility by default).
+// operator new and delete are implemented on top of malloc and free.
+//------------------------------------------------------------------------
+extern "C" {
+void *__libc_malloc(size_t size);
+void __libc_free(void *ptr);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+using namespace Steinberg::Vst::RTGuard;
+
+#define RTGUARD_EXPORT extern "C" __attribute__((visibility("default")))
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT void *malloc(size_t size) {
+  countAllocation();
+  return __libc_malloc(size);
+}
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT void free(void *ptr) {
+  countDeallocation(ptr);
+  __libc_free(ptr);
+}
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT void *calloc(size_t count, size_t size) {
+  countAllocation();
+  return __libc_calloc(count, size);
+}
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT void *realloc(void *ptr, size_t size) {
+  countAllocation();
+  return __libc_realloc(ptr, size);
+}
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT int posix_memalign(void **result, size_t alignment,
+                                  size_t size) {
+  countAllocation();
+  if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+  auto ptr = __libc_memalign(alignment, size);
+  if (!ptr)
+    return ENOMEM;
+  *result = ptr;
+  return 0;
+}
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT void *aligned_alloc(size_t alignment, size_t size) {
+  countAllocation();
+  return __libc_memalign(alignment, size);
+}
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT void *memalign(size_t alignment, size_t size) {
+  countAllocation();
+  return __libc_memalign(alignment, size);
+}
+
+//------------------------------------------------------------------------
+using MutexLockFunc = int (*)(pthread_mutex_t *);
+
+//! Resolved during static initialization, dlsym may allocate itself.
+static MutexLockFunc realMutexLock = reinterpret_cast<MutexLockFunc>(
+    dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+
+//------------------------------------------------------------------------
+RTGUARD_EXPORT int pthread_mutex_lock(pthread_mutex_t *mutex) {
+  countLock();
+  if (!realMutexLock)
+    realMutexLock = reinterpret_cast<MutexLockFunc>(
+        dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+  return realMutexLock(mutex);
+}
+#endif // MIN_VST_HOST_RT_GUARD
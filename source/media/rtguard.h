@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pluginterfaces/vst/vsttypes.h"
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+namespace RTGuard {
+
+//------------------------------------------------------------------------
+/** Realtime-safety diagnostics.
+ *
+ *  With MIN_VST_HOST_RT_GUARD the host interposes malloc, free, calloc,
+ *  realloc, the aligned allocators (and so operator new/delete) and
+ *  pthread_mutex_lock. Calls made by a thread inside a Scope are counted
+ *  into the Scope's Counters. Without it a Scope does nothing.
+ */
+struct Counters {
+  uint64 allocations = 0;
+  uint64 deallocations = 0;
+  uint64 locks = 0;
+
+  uint64 total() const { return allocations + deallocations + locks; }
+};
+
+//------------------------------------------------------------------------
+class Scope {
+public:
+  //! Resets counters and tags the calling thread until destruction.
+  explicit Scope(Counters &counters);
+  ~Scope();
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  Counters *previous;
+};
+
+//------------------------------------------------------------------------
+//! True if the hooks are compiled in.
+bool isAvailable();
+
+//! Writes a backtrace to stderr for the next maxCount guarded calls.
+void enableBacktraces(uint32 maxCount);
+
+//------------------------------------------------------------------------
+} // namespace RTGuard
+} // namespace Vst
+} // namespace Steinberg
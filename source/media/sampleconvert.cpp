@@ -0,0 +1,159 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/media/sampleconvert.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MIN_VST_HOST_X86 1
+#endif
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+static void toSample64Scalar(const Sample32 *src, Sample64 *dest, int32 i,
+                             int32 numSamples) {
+  for (; i < numSamples; ++i)
+    dest[i] = static_cast<Sample64>(src[i]);
+}
+
+//------------------------------------------------------------------------
+static void toSample32Scalar(const Sample64 *src, Sample32 *dest, int32 i,
+                             int32 numSamples) {
+  for (; i < numSamples; ++i)
+    dest[i] = static_cast<Sample32>(src[i]);
+}
+
+#if MIN_VST_HOST_X86
+//------------------------------------------------------------------------
+__attribute__((target("sse2"))) static void
+toSample64SSE2(const Sample32 *src, Sample64 *dest, int32 numSamples) {
+  int32 i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    auto in = _mm_loadu_ps(src + i);
+    _mm_storeu_pd(dest + i, _mm_cvtps_pd(in));
+    _mm_storeu_pd(dest + i + 2, _mm_cvtps_pd(_mm_movehl_ps(in, in)));
+  }
+  toSample64Scalar(src, dest, i, numSamples);
+}
+
+//------------------------------------------------------------------------
+__attribute__((target("sse2"))) static void
+toSample32SSE2(const Sample64 *src, Sample32 *dest, int32 numSamples) {
+  int32 i = 0;
+  for (; i + 4 <= numSamples; i += 4) {
+    auto low = _mm_cvtpd_ps(_mm_loadu_pd(src + i));
+    auto high = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+    _mm_storeu_ps(dest + i, _mm_movelh_ps(low, high));
+  }
+  toSample32Scalar(src, dest, i, numSamples);
+}
+
+//------------------------------------------------------------------------
+__attribute__((target("avx"))) static void
+toSample64AVX(const Sample32 *src, Sample64 *dest, int32 numSamples) {
+  int32 i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    _mm256_storeu_pd(dest + i, _mm256_cvtps_pd(_mm_loadu_ps(src + i)));
+    _mm256_storeu_pd(dest + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(src + i + 4)));
+  }
+  toSample64Scalar(src, dest, i, numSamples);
+}
+
+//------------------------------------------------------------------------
+__attribute__((target("avx"))) static void
+toSample32AVX(const Sample64 *src, Sample32 *dest, int32 numSamples) {
+  int32 i = 0;
+  for (; i + 8 <= numSamples; i += 8) {
+    auto low = _mm256_cvtpd_ps(_mm256_loadu_pd(src + i));
+    auto high = _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4));
+    _mm256_storeu_ps(dest + i, _mm256_set_m128(high, low));
+  }
+  toSample32Scalar(src, dest, i, numSamples);
+}
+#endif
+
+//------------------------------------------------------------------------
+using ToSample64Func = void (*)(const Sample32 *, Sample64 *, int32);
+using ToSample32Func = void (*)(const Sample64 *, Sample32 *, int32);
+
+//------------------------------------------------------------------------
+static void toSample64Generic(const Sample32 *src, Sample64 *dest,
+                              int32 numSamples) {
+  toSample64Scalar(src, dest, 0, numSamples);
+}
+
+//------------------------------------------------------------------------
+static void toSample32Generic(const Sample64 *src, Sample32 *dest,
+                              int32 numSamples) {
+  toSample32Scalar(src, dest, 0, numSamples);
+}
+
+//------------------------------------------------------------------------
+static ToSample64Func selectToSample64() {
+#if MIN_VST_HOST_X86
+  __builtin_cpu_init(); // may run before libgcc's constructor
+  if (__builtin_cpu_supports("avx"))
+    return toSample64AVX;
+  if (__builtin_cpu_supports("sse2"))
+    return toSample64SSE2;
+#endif
+  return toSample64Generic;
+}
+
+//------------------------------------------------------------------------
+static ToSample32Func selectToSample32() {
+#if MIN_VST_HOST_X86
+  __builtin_cpu_init(); // may run before libgcc's constructor
+  if (__builtin_cpu_supports("avx"))
+    return toSample32AVX;
+  if (__builtin_cpu_supports("sse2"))
+    return toSample32SSE2;
+#endif
+  return toSample32Generic;
+}
+
+static const ToSample64Func gToSample64 = selectToSample64();
+static const ToSample32Func gToSample32 = selectToSample32();
+
+//------------------------------------------------------------------------
+void convertToSample64(const Sample32 *src, Sample64 *dest, int32 numSamples) {
+  gToSample64(src, dest, numSamples);
+}
+
+//------------------------------------------------------------------------
+void convertToSample32(const Sample64 *src, Sample32 *dest, int32 numSamples) {
+  gToSample32(src, dest, numSamples);
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+/** Bounded wait-free single producer / single consumer ring buffer.
+ *
+ *  push() is called by exactly one thread and pop() by exactly one other
+ *  thread; neither locks nor allocates. reset() allocates the storage and
+ *  must not run concurrently with push() or pop().
+ */
+template <typename T>
+class SPSCQueue {
+public:
+  explicit SPSCQueue(size_t capacity = 0) { reset(capacity); }
+
+  //! Capacity is rounded up to the next power of two.
+  void reset(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    slots.assign(capacity ? size : 0, T{});
+    mask = slots.empty() ? 0 : slots.size() - 1;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    cachedTail = 0;
+    cachedHead = 0;
+  }
+
+  size_t capacity() const { return slots.size(); }
+
+  //! Returns false if the queue is full; the value is not stored then.
+  bool push(const T &value) {
+    auto writePos = tail.load(std::memory_order_relaxed);
+    if (writePos - cachedHead >= slots.size()) {
+      cachedHead = head.load(std::memory_order_acquire);
+      if (writePos - cachedHead >= slots.size())
+        return false;
+    }
+    slots[writePos & mask] = value;
+    tail.store(writePos + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Returns false if the queue is empty.
+  bool pop(T &value) {
+    auto readPos = head.load(std::memory_order_relaxed);
+    if (readPos == cachedTail) {
+      cachedTail = tail.load(std::memory_order_acquire);
+      if (readPos == cachedTail)
+        return false;
+    }
+    value = slots[readPos & mask];
+    head.store(readPos + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::vector<T> slots;
+  size_t mask = 0;
+
+  // consumer side
+  alignas(kCacheLineSize) std::atomic<size_t> head{0};
+  size_t cachedTail = 0;
+
+  // producer side
+  alignas(kCacheLineSize) std::atomic<size_t> tail{0};
+  size_t cachedHead = 0;
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
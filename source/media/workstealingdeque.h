@@ -0,0 +1,120 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+/** Bounded Chase-Lev work-stealing deque of trivially copyable values.
+ *
+ *  The owning thread calls push() and pop() at the bottom, any other thread
+ *  may steal() from the top. Nothing locks or allocates after reset(), which
+ *  must not run concurrently with the other calls. Callers must not push
+ *  more than capacity values without taking them out again.
+ */
+template <typename T>
+class WorkStealingDeque {
+public:
+  explicit WorkStealingDeque(size_t capacity = 0) { reset(capacity); }
+
+  void reset(size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    slots.reset(new std::atomic<T>[size]);
+    mask = size - 1;
+    top.store(0, std::memory_order_relaxed);
+    bottom.store(0, std::memory_order_relaxed);
+  }
+
+  //! Owner only.
+  void push(T value) {
+    auto b = bottom.load(std::memory_order_relaxed);
+    slots[b & mask].store(value, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  //! Owner only. Returns false if the deque is empty.
+  bool pop(T &value) {
+    auto b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+
+    value = slots[b & mask].load(std::memory_order_relaxed);
+    if (t == b) {
+      // last element, race against thieves
+      auto won = top.compare_exchange_strong(t, t + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  //! Any thread. Returns false if the deque is empty or the race was lost.
+  bool steal(T &value) {
+    auto t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = bottom.load(std::memory_order_acquire);
+    if (t >= b)
+      return false;
+
+    value = slots[t & mask].load(std::memory_order_relaxed);
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::unique_ptr<std::atomic<T>[]> slots;
+  int64_t mask = 0;
+
+  alignas(kCacheLineSize) std::atomic<int64_t> top{0};
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom{0};
+};
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
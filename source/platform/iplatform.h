@@ -53,6 +53,11 @@ public:
 
   virtual FUnknown *getPluginFactoryContext() = 0;
 
+  using TimerCallback = std::function<void()>;
+  virtual uint64_t registerTimer(uint64_t intervalMs,
+                                 const TimerCallback &callback) = 0;
+  virtual void unregisterTimer(uint64_t timerID) = 0;
+
   static IPlatform &instance();
 };
 
@@ -74,6 +74,10 @@ public:
 
   FUnknown *getPluginFactoryContext() override;
 
+  uint64_t registerTimer(uint64_t intervalMs,
+                         const TimerCallback &callback) override;
+  void unregisterTimer(uint64_t timerID) override;
+
   void run(const std::vector<std::string> &cmdArgs);
 
   static const int kMinEventLoopRate = 16; // 60Hz
@@ -100,6 +104,8 @@ void Platform::setApplication(ApplicationPtr &&app) {
 WindowPtr Platform::createWindow(const std::string &title, Size size,
                                  bool resizeable,
                                  const WindowControllerPtr &controller) {
+  if (!xDisplay)
+    return nullptr;
   auto window =
       X11Window::make(title, size, resizeable, controller, xDisplay,
                       [this](X11Window *window) { onWindowClosed(window); });
@@ -153,16 +159,44 @@ FUnknown *Platform::getPluginFactoryContext() {
   return &Steinberg::Linux::RunLoopImpl::instance();
 }
 
+//------------------------------------------------------------------------
+uint64_t Platform::registerTimer(uint64_t intervalMs,
+                                 const TimerCallback &callback) {
+  return RunLoop::instance().registerTimer(intervalMs,
+                                           [callback](auto) { callback(); });
+}
+
+//------------------------------------------------------------------------
+void Platform::unregisterTimer(uint64_t timerID) {
+  RunLoop::instance().unregisterTimer(timerID);
+}
+
+//------------------------------------------------------------------------
+//! Commands that open no window, they run without X server even if one is
+//! reachable.
+static bool isHeadlessCommand(const std::vector<std::string> &cmdArgs) {
+  for (const auto &arg : cmdArgs) {
+    if (arg == "--scan" || arg == "--render")
+      return true;
+  }
+  return false;
+}
+
 //------------------------------------------------------------------------
 void Platform::run(const std::vector<std::string> &cmdArgs) {
+  if (isHeadlessCommand(cmdArgs)) {
+    application->init(cmdArgs);
+    return;
+  }
+
   // Connect to X server
-  std::string displayName(getenv("DISPLAY"));
+  auto displayEnv = getenv("DISPLAY");
+  std::string displayName(displayEnv ? displayEnv : "");
   if (displayName.empty())
     displayName = ":0.0";
 
-  if ((xDisplay = XOpenDisplay(displayName.data())) == nullptr) {
-    return;
-  }
+  if ((xDisplay = XOpenDisplay(displayName.data())) == nullptr)
+    kill(-1, "Could not connect to X server " + displayName);
 
   RunLoop::instance().setDisplay(xDisplay);
 
@@ -30,6 +30,9 @@
 #include "source/platform/linux/runloop.h"
 #include <algorithm>
 #include <iostream>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 //------------------------------------------------------------------------
 namespace Steinberg {
@@ -38,12 +41,43 @@ namespace EditorHost {
 
 using LockGuard = std::lock_guard<std::recursive_mutex>;
 
+static const int kMaxEpollEvents = 32;
+
 //------------------------------------------------------------------------
 RunLoop &RunLoop::instance() {
   static RunLoop gInstance;
   return gInstance;
 }
 
+//------------------------------------------------------------------------
+RunLoop::RunLoop() {
+  epollFD = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFD == -1) {
+    std::cerr << "Could not create the run loop's epoll instance\n";
+    return;
+  }
+  timerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (timerFD == -1) {
+    std::cerr << "Could not create the run loop's timer, timers will not "
+                 "fire\n";
+    return;
+  }
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = timerFD;
+  if (epoll_ctl(epollFD, EPOLL_CTL_ADD, timerFD, &event) != 0)
+    std::cerr << "Could not watch the run loop's timer\n";
+}
+
+//------------------------------------------------------------------------
+RunLoop::~RunLoop() noexcept {
+  if (timerFD != -1)
+    close(timerFD);
+  if (epollFD != -1)
+    close(epollFD);
+}
+
 //------------------------------------------------------------------------
 void RunLoop::setDisplay(Display *display) { this->display = display; }
 
@@ -63,7 +97,16 @@ void RunLoop::unregisterWindow(XID window) {
 //------------------------------------------------------------------------
 void RunLoop::registerFileDescriptor(int fd,
                                      const FileDescriptorCallback &callback) {
-  fileDescriptors.emplace(fd, callback);
+  if (!fileDescriptors.emplace(fd, callback).second)
+    return;
+
+  //! Level triggered like select(); EPOLLERR and EPOLLHUP are always
+  //! reported and dispatched to the same callback.
+  epoll_event event{};
+  event.events = EPOLLIN | EPOLLPRI;
+  event.data.fd = fd;
+  if (epoll_ctl(epollFD, EPOLL_CTL_ADD, fd, &event) != 0)
+    std::cerr << "Could not watch file descriptor " << fd << "\n";
 }
 
 //------------------------------------------------------------------------
@@ -72,28 +115,57 @@ void RunLoop::unregisterFileDescriptor(int fd) {
   if (it == fileDescriptors.end())
     return;
   fileDescriptors.erase(it);
+  // fails harmlessly if the descriptor was already closed
+  epoll_ctl(epollFD, EPOLL_CTL_DEL, fd, nullptr);
 }
 
 //------------------------------------------------------------------------
-void RunLoop::select(timeval *timeout) {
-  int nfds = 0;
-  fd_set readFDs = {}, exceptFDs = {};
-
-  for (auto &e : fileDescriptors) {
-    int fd = e.first;
-    FD_SET(fd, &readFDs);
-    FD_SET(fd, &exceptFDs);
-    nfds = std::max(nfds, fd);
+void RunLoop::wait() {
+  epoll_event events[kMaxEpollEvents];
+  int count = epoll_wait(epollFD, events, kMaxEpollEvents, -1);
+
+  for (int i = 0; i < count; ++i) {
+    int fd = events[i].data.fd;
+    if (fd == timerFD) {
+      handleTimers();
+      continue;
+    }
+    // a previous callback may have unregistered this descriptor
+    auto it = fileDescriptors.find(fd);
+    if (it == fileDescriptors.end())
+      continue;
+    auto callback = it->second;
+    callback(fd);
   }
+}
 
-  int result = ::select(nfds, &readFDs, nullptr, nullptr, timeout);
+//------------------------------------------------------------------------
+void RunLoop::handleTimers() {
+  uint64_t expirations;
+  while (read(timerFD, &expirations, sizeof(expirations)) > 0)
+    continue;
 
-  if (result > 0) {
-    for (auto &e : fileDescriptors) {
-      if (FD_ISSET(e.first, &readFDs) || FD_ISSET(e.first, &exceptFDs))
-        e.second(e.first);
-    }
+  armTimer(timerProcessor.handleTimersAndReturnNextFireTime());
+}
+
+//------------------------------------------------------------------------
+void RunLoop::armTimer(TimerProcessor::Duration timeout) {
+  using namespace std::chrono;
+
+  if (timerFD == -1)
+    return;
+
+  itimerspec spec{};
+  if (timeout != TimerProcessor::noTimers) {
+    auto secs = duration_cast<seconds>(timeout);
+    spec.it_value.tv_sec = static_cast<time_t>(secs.count());
+    spec.it_value.tv_nsec =
+        static_cast<long>(duration_cast<nanoseconds>(timeout - secs).count());
+    // a zero it_value would disarm the timer
+    if (timeout == TimerProcessor::Duration::zero())
+      spec.it_value.tv_nsec = 1;
   }
+  timerfd_settime(timerFD, 0, &spec, nullptr);
 }
 
 //------------------------------------------------------------------------
@@ -121,21 +193,22 @@ bool RunLoop::handleEvents() {
 //------------------------------------------------------------------------
 TimerID RunLoop::registerTimer(TimerInterval interval,
                                const TimerCallback &callback) {
-  return timerProcessor.registerTimer(interval, callback);
+  auto id = timerProcessor.registerTimer(interval, callback);
+  armTimer(timerProcessor.getNextFireTime());
+  return id;
 }
 
 //------------------------------------------------------------------------
 void RunLoop::unregisterTimer(TimerID id) {
   timerProcessor.unregisterTimer(id);
+  // the removed timer may have been the one the timerfd is armed for
+  armTimer(timerProcessor.getNextFireTime());
 }
 
-//------------------------------------------------------------------------
-bool timeValEmpty(timeval &val) { return val.tv_sec == 0 && val.tv_usec == 0; }
-
 //------------------------------------------------------------------------
 void RunLoop::start() {
-  using namespace std::chrono;
-  using clock = high_resolution_clock;
+  if (epollFD == -1)
+    return;
 
   running = true;
 
@@ -144,18 +217,16 @@ void RunLoop::start() {
 
   XSync(display, false);
   handleEvents();
-  timeval selectTimeout{};
+  armTimer(timerProcessor.getNextFireTime());
   while (running && !map.empty()) {
-    select(timeValEmpty(selectTimeout) ? nullptr : &selectTimeout);
-    auto nextFireTime = timerProcessor.handleTimersAndReturnNextFireTimeInMs();
-    if (nextFireTime == TimerProcessor::noTimers) {
-      selectTimeout = {};
-    } else {
-      selectTimeout.tv_sec = nextFireTime / 1000;
-      selectTimeout.tv_usec =
-          (nextFireTime - (selectTimeout.tv_sec * 1000)) * 1000;
-    }
+    //! Xlib may already have read events from the socket into its queue,
+    //! those would not wake up epoll.
+    if (XEventsQueued(display, QueuedAlready) > 0)
+      handleEvents();
+    wait();
   }
+
+  unregisterFileDescriptor(fd);
 }
 
 //------------------------------------------------------------------------
@@ -164,85 +235,160 @@ void RunLoop::stop() { running = false; }
 //------------------------------------------------------------------------
 //------------------------------------------------------------------------
 //------------------------------------------------------------------------
-uint64_t TimerProcessor::handleTimersAndReturnNextFireTimeInMs() {
-  using std::chrono::time_point_cast;
+auto TimerProcessor::handleTimersAndReturnNextFireTime() -> Duration {
+  auto current = Clock::now();
+  while (!heap.empty()) {
+    auto slot = heap.front();
+    auto &timer = timers[slot];
+    if (timer.nextFireTime > current)
+      break;
+
+    // keep the phase, but do not try to catch up on missed ticks
+    timer.nextFireTime += timer.interval;
+    if (timer.nextFireTime <= current)
+      timer.nextFireTime = current + timer.interval;
+    siftDown(0);
+
+    firingSlot = slot;
+    timer.callback(makeTimerID(slot, timer.generation));
+    firingSlot = kNoSlot;
+    if (!timer.active)
+      releaseSlot(slot);
+  }
 
-  if (timers.empty())
+  return getNextFireTime();
+}
+
+//------------------------------------------------------------------------
+auto TimerProcessor::getNextFireTime() const -> Duration {
+  if (heap.empty())
     return noTimers;
 
-  auto current = time_point_cast<Millisecond>(Clock::now());
+  auto remaining = timers[heap.front()].nextFireTime - Clock::now();
+  return std::max(remaining, Duration::zero());
+}
 
-  std::vector<TimerID> timersToFire;
-  for (auto &timer : timers) {
-    if (timer.nextFireTime > current)
-      break;
-    timersToFire.push_back(timer.id);
-    updateTimerNextFireTime(timer, current);
+//------------------------------------------------------------------------
+auto TimerProcessor::registerTimer(TimerInterval interval,
+                                   const TimerCallback &callback) -> TimerID {
+  SlotIndex slot;
+  if (freeSlots.empty()) {
+    slot = static_cast<SlotIndex>(timers.size());
+    timers.emplace_back();
+  } else {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
   }
 
-  for (auto id : timersToFire) {
-    for (auto &timer : timers) {
-      if (timer.id == id) {
-        timer.callback(timer.id);
-        break;
-      }
-    }
-  }
-  if (timersToFire.empty())
-    return noTimers;
+  auto &timer = timers[slot];
+  timer.callback = callback;
+  timer.interval = std::max<Duration>(std::chrono::milliseconds(interval),
+                                      Duration(1));
+  timer.nextFireTime = Clock::now() + timer.interval;
+  timer.generation++;
+  timer.active = true;
+  heapPush(slot);
+
+  return makeTimerID(slot, timer.generation);
+}
 
-  sortTimers();
+//------------------------------------------------------------------------
+void TimerProcessor::unregisterTimer(TimerID id) {
+  auto timer = findTimer(id);
+  if (!timer)
+    return;
 
-  auto nextFireTime = timers.front().nextFireTime;
-  current = now();
-  if (nextFireTime < current)
-    return 0;
-  return (nextFireTime - current).count();
+  heapRemove(timer->heapIndex);
+  timer->active = false;
+  // a timer unregistering itself is released after its callback returned
+  auto slot = static_cast<SlotIndex>(id & 0xFFFFFFFF);
+  if (slot != firingSlot)
+    releaseSlot(slot);
 }
 
 //------------------------------------------------------------------------
-void TimerProcessor::updateTimerNextFireTime(Timer &timer, TimePoint current) {
-  timer.nextFireTime = current + Millisecond(timer.interval);
+TimerID TimerProcessor::makeTimerID(SlotIndex slot, uint32_t generation) {
+  return (static_cast<TimerID>(generation) << 32) | slot;
 }
 
 //------------------------------------------------------------------------
-void TimerProcessor::sortTimers() {
-  std::sort(timers.begin(), timers.end(), [](const Timer &t1, const Timer &t2) {
-    return t1.nextFireTime < t2.nextFireTime;
-  });
+auto TimerProcessor::findTimer(TimerID id) -> Timer * {
+  auto slot = static_cast<SlotIndex>(id & 0xFFFFFFFF);
+  auto generation = static_cast<uint32_t>(id >> 32);
+  if (slot >= timers.size())
+    return nullptr;
+  auto &timer = timers[slot];
+  if (!timer.active || timer.generation != generation)
+    return nullptr;
+  return &timer;
 }
 
 //------------------------------------------------------------------------
-auto TimerProcessor::now() -> TimePoint {
-  using std::chrono::time_point_cast;
+void TimerProcessor::releaseSlot(SlotIndex slot) {
+  timers[slot].callback = nullptr;
+  freeSlots.push_back(slot);
+}
 
-  return time_point_cast<Millisecond>(Clock::now());
+//------------------------------------------------------------------------
+bool TimerProcessor::isBefore(SlotIndex a, SlotIndex b) const {
+  return timers[a].nextFireTime < timers[b].nextFireTime;
 }
 
 //------------------------------------------------------------------------
-auto TimerProcessor::registerTimer(TimerInterval interval,
-                                   const TimerCallback &callback) -> TimerID {
-  auto timerId = ++timerIdCounter;
-  Timer timer;
-  timer.id = timerId;
-  timer.callback = callback;
-  timer.interval = interval;
-  updateTimerNextFireTime(timer, now());
+void TimerProcessor::heapSet(SlotIndex heapIndex, SlotIndex slot) {
+  heap[heapIndex] = slot;
+  timers[slot].heapIndex = heapIndex;
+}
+
+//------------------------------------------------------------------------
+void TimerProcessor::heapPush(SlotIndex slot) {
+  heap.push_back(slot);
+  heapSet(static_cast<SlotIndex>(heap.size() - 1), slot);
+  siftUp(timers[slot].heapIndex);
+}
+
+//------------------------------------------------------------------------
+void TimerProcessor::heapRemove(SlotIndex heapIndex) {
+  timers[heap[heapIndex]].heapIndex = kNoSlot;
+  auto last = heap.back();
+  heap.pop_back();
+  if (heapIndex == heap.size())
+    return;
 
-  timers.emplace_back(std::move(timer));
-  sortTimers();
+  heapSet(heapIndex, last);
+  siftUp(heapIndex);
+  siftDown(timers[last].heapIndex);
+}
 
-  return timerId;
+//------------------------------------------------------------------------
+void TimerProcessor::siftUp(SlotIndex heapIndex) {
+  auto slot = heap[heapIndex];
+  while (heapIndex > 0) {
+    auto parent = (heapIndex - 1) / 2;
+    if (!isBefore(slot, heap[parent]))
+      break;
+    heapSet(heapIndex, heap[parent]);
+    heapIndex = parent;
+  }
+  heapSet(heapIndex, slot);
 }
 
 //------------------------------------------------------------------------
-void TimerProcessor::unregisterTimer(TimerID id) {
-  for (auto it = timers.begin(), end = timers.end(); it != end; ++it) {
-    if (it->id == id) {
-      timers.erase(it);
+void TimerProcessor::siftDown(SlotIndex heapIndex) {
+  auto size = static_cast<SlotIndex>(heap.size());
+  auto slot = heap[heapIndex];
+  while (true) {
+    auto child = 2 * heapIndex + 1;
+    if (child >= size)
       break;
-    }
+    if (child + 1 < size && isBefore(heap[child + 1], heap[child]))
+      ++child;
+    if (!isBefore(heap[child], slot))
+      break;
+    heapSet(heapIndex, heap[child]);
+    heapIndex = child;
   }
+  heapSet(heapIndex, slot);
 }
 
 //------------------------------------------------------------------------
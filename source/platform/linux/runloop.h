@@ -31,7 +31,9 @@
 
 #include <X11/Xlib.h>
 #include <chrono>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -48,32 +50,55 @@ using TimerInterval = uint64_t;
 using TimerCallback = std::function<void(TimerID)>;
 
 //------------------------------------------------------------------------
+/** Timers kept in an indexed binary min-heap on their next fire time.
+ *
+ *  TimerIDs stay valid until the timer is unregistered (slot index plus a
+ *  generation count), registering and unregistering is O(log n) and a tick
+ *  does not allocate. Callbacks may (un)register timers, including their own.
+ */
 class TimerProcessor {
 public:
+  using Clock = std::chrono::steady_clock;
+  using Duration = Clock::duration;
+
   TimerID registerTimer(TimerInterval interval, const TimerCallback &callback);
   void unregisterTimer(TimerID id);
 
-  static constexpr uint64_t noTimers = std::numeric_limits<uint64_t>::max();
-  uint64_t handleTimersAndReturnNextFireTimeInMs();
+  static constexpr Duration noTimers = Duration::max();
+  Duration handleTimersAndReturnNextFireTime();
+  Duration getNextFireTime() const;
 
 private:
-  using Clock = std::chrono::steady_clock;
-  using Millisecond = std::chrono::milliseconds;
-  using TimePoint = std::chrono::time_point<Clock, Millisecond>;
+  using TimePoint = Clock::time_point;
+  using SlotIndex = uint32_t;
+  static constexpr SlotIndex kNoSlot = std::numeric_limits<SlotIndex>::max();
 
   struct Timer {
-    TimerID id;
-    TimerInterval interval;
     TimerCallback callback;
-    TimePoint nextFireTime;
+    Duration interval{};
+    TimePoint nextFireTime{};
+    uint32_t generation{0};
+    SlotIndex heapIndex{kNoSlot};
+    bool active{false};
   };
-  using Timers = std::vector<Timer>;
-  Timers timers;
-  TimerID timerIdCounter{0};
+  //! a deque keeps a firing timer in place while its callback registers more
+  using Timers = std::deque<Timer>;
+  using SlotIndices = std::vector<SlotIndex>;
 
-  void updateTimerNextFireTime(Timer &timer, TimePoint current);
-  void sortTimers();
-  TimePoint now();
+  Timers timers;
+  SlotIndices freeSlots;
+  SlotIndices heap;
+  SlotIndex firingSlot{kNoSlot};
+
+  static TimerID makeTimerID(SlotIndex slot, uint32_t generation);
+  Timer *findTimer(TimerID id);
+  void releaseSlot(SlotIndex slot);
+  bool isBefore(SlotIndex a, SlotIndex b) const;
+  void heapSet(SlotIndex heapIndex, SlotIndex slot);
+  void heapPush(SlotIndex slot);
+  void heapRemove(SlotIndex heapIndex);
+  void siftUp(SlotIndex heapIndex);
+  void siftDown(SlotIndex heapIndex);
 };
 
 //------------------------------------------------------------------------
@@ -84,6 +109,9 @@ public:
 
   static RunLoop &instance();
 
+  RunLoop();
+  ~RunLoop() noexcept;
+
   void setDisplay(Display *display);
 
   void registerWindow(XID window, const EventCallback &callback);
@@ -99,8 +127,10 @@ public:
   void stop();
 
 private:
-  void select(timeval *timeout = nullptr);
+  void wait();
   bool handleEvents();
+  void handleTimers();
+  void armTimer(TimerProcessor::Duration timeout);
 
   using WindowMap = std::unordered_map<XID, EventCallback>;
   using FileDescriptorCallbacks =
@@ -112,6 +142,8 @@ private:
 
   Display *display{nullptr};
   bool running{false};
+  int epollFD{-1};
+  int timerFD{-1};
 };
 
 //------------------------------------------------------------------------
@@ -0,0 +1,311 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/pluginscanner.h"
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "public.sdk/source/vst/hosting/module.h"
+#include "public.sdk/source/vst/hosting/plugprovider.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+using Clock = std::chrono::steady_clock;
+
+//------------------------------------------------------------------------
+static double millisecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+//------------------------------------------------------------------------
+std::vector<std::string> findModulePaths(const std::string &directory) {
+  namespace fs = std::filesystem;
+  std::vector<std::string> paths;
+  std::error_code ec;
+  fs::recursive_directory_iterator it(
+      directory, fs::directory_options::follow_directory_symlink |
+                     fs::directory_options::skip_permission_denied,
+      ec);
+  for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+    if (it->path().extension() != ".vst3" || !it->is_directory(ec))
+      continue;
+    paths.push_back(it->path().string());
+    it.disable_recursion_pending();
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+//------------------------------------------------------------------------
+using PlugProviders = std::vector<IPtr<PlugProvider>>;
+
+//------------------------------------------------------------------------
+//! Runs in the forked worker: loads and probes one module and stores the
+//! result as a one-entry scan cache at resultPath.
+static bool scanInWorker(const std::string &modulePath,
+                         const std::string &resultPath,
+                         FUnknown *hostContext, PlugProviders &providers,
+                         std::string &error) {
+  ScannedModule module;
+  module.path = modulePath;
+  if (!statModule(modulePath, module.mtime, module.size)) {
+    error = "Could not find module binary";
+    return false;
+  }
+
+  auto start = Clock::now();
+  auto pluginModule = VST3::Hosting::Module::create(modulePath, error);
+  if (!pluginModule)
+    return false;
+  module.loadTimeMs = millisecondsSince(start);
+
+  auto factory = pluginModule->getFactory();
+  if (hostContext)
+    factory.setHostContext(hostContext);
+  for (const auto &classInfo : factory.classInfos()) {
+    auto scannedClass = makeScannedClass(classInfo);
+    if (classInfo.category() == kVstAudioEffectClass) {
+      auto provider = owned(new PlugProvider(factory, classInfo, true));
+      if (provider->initialize()) {
+        auto component = owned(provider->getComponent());
+        auto controller = owned(provider->getController());
+        if (component)
+          probeScannedClass(component, controller, scannedClass);
+      }
+      providers.push_back(provider);
+    }
+    module.classes.push_back(std::move(scannedClass));
+  }
+
+  ScanCache result;
+  if (!result.load(resultPath, error))
+    return false;
+  result.store(std::move(module));
+  return result.save(error);
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+//------------------------------------------------------------------------
+struct Worker {
+  pid_t pid = -1;
+  int errorFD = -1;
+  size_t index = 0;
+  std::string resultPath;
+  Clock::time_point start;
+  std::string error;
+};
+
+//------------------------------------------------------------------------
+} // namespace
+
+//------------------------------------------------------------------------
+static bool startWorker(Worker &worker, const std::string &modulePath,
+                        FUnknown *hostContext) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return false;
+
+  std::fflush(stdout);
+  std::fflush(stderr);
+  worker.start = Clock::now();
+  worker.pid = fork();
+  if (worker.pid == 0) {
+    close(fds[0]);
+    // The providers are never released: the worker exits right after
+    // reporting, a plug-in that hangs in terminate must not cost a result.
+    PlugProviders providers;
+    std::string error;
+    auto success = scanInWorker(modulePath, worker.resultPath, hostContext,
+                                providers, error);
+    if (!error.empty()) {
+      auto size = std::min<size_t>(error.size(), PIPE_BUF);
+      (void)!write(fds[1], error.data(), size);
+    }
+    _exit(success ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  close(fds[1]);
+  if (worker.pid < 0) {
+    close(fds[0]);
+    return false;
+  }
+  worker.errorFD = fds[0];
+  return true;
+}
+
+//------------------------------------------------------------------------
+static void finishWorker(Worker &worker, bool timedOut, ScanCache &cache,
+                         PluginScanReport &report) {
+  if (timedOut)
+    ::kill(worker.pid, SIGKILL);
+  close(worker.errorFD);
+  int status = 0;
+  waitpid(worker.pid, &status, 0);
+  report.totalTimeMs = millisecondsSince(worker.start);
+
+  if (timedOut) {
+    report.status = PluginScanReport::Status::kTimedOut;
+    report.error = "timed out";
+  } else if (WIFSIGNALED(status)) {
+    report.status = PluginScanReport::Status::kCrashed;
+    report.error = strsignal(WTERMSIG(status));
+  } else if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) {
+    ScanCache result;
+    std::string error;
+    const ScannedModule *module = nullptr;
+    if (result.load(worker.resultPath, error))
+      module = result.find(report.path);
+    if (module) {
+      report.status = PluginScanReport::Status::kScanned;
+      report.loadTimeMs = module->loadTimeMs;
+      report.numClasses = module->classes.size();
+      cache.store(*module);
+    } else {
+      report.status = PluginScanReport::Status::kFailed;
+      report.error = error.empty() ? "module changed during scan" : error;
+    }
+  } else {
+    report.status = PluginScanReport::Status::kFailed;
+    report.error = worker.error;
+  }
+  unlink(worker.resultPath.data());
+}
+
+//------------------------------------------------------------------------
+PluginScanReports scanPlugins(const std::vector<std::string> &modulePaths,
+                              ScanCache &cache,
+                              const PluginScanOptions &options) {
+  PluginScanReports reports(modulePaths.size());
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < modulePaths.size(); ++i) {
+    auto &report = reports[i];
+    report.path = modulePaths[i];
+    auto cached = options.rescan ? nullptr : cache.find(report.path);
+    // entries from moduleinfo.json or the editor lack the load time
+    if (cached && cached->loadTimeMs >= 0.) {
+      report.status = PluginScanReport::Status::kCached;
+      report.loadTimeMs = cached->loadTimeMs;
+      report.numClasses = cached->classes.size();
+    } else {
+      // the classes are known even if the worker fails, it still loads the
+      // module to time it and to probe the classes
+      ScannedModule moduleInfo;
+      if (!cache.find(report.path) && scanModuleInfo(report.path, moduleInfo))
+        cache.store(std::move(moduleInfo));
+      pending.push_back(i);
+    }
+  }
+
+  auto numWorkers = static_cast<size_t>(options.numWorkers);
+  if (numWorkers == 0)
+    numWorkers = static_cast<size_t>(std::max(sysconf(_SC_NPROCESSORS_ONLN),
+                                              1L));
+  std::string tempDirectory = "/tmp";
+  if (auto tmp = std::getenv("TMPDIR"); tmp && *tmp)
+    tempDirectory = tmp;
+  auto tempPrefix = tempDirectory + "/min-vst-host-scan-" +
+                    std::to_string(getpid()) + "-";
+
+  std::vector<Worker> workers;
+  std::vector<pollfd> pollFDs;
+  auto next = pending.begin();
+  while (next != pending.end() || !workers.empty()) {
+    while (workers.size() < numWorkers && next != pending.end()) {
+      Worker worker;
+      worker.index = *next++;
+      worker.resultPath = tempPrefix + std::to_string(worker.index);
+      if (startWorker(worker, modulePaths[worker.index], options.hostContext))
+        workers.push_back(std::move(worker));
+      else
+        reports[worker.index].error = "Could not start worker process";
+    }
+
+    pollFDs.clear();
+    auto timeoutMs = options.timeoutMs;
+    for (const auto &worker : workers) {
+      pollFDs.push_back({worker.errorFD, POLLIN, 0});
+      auto remaining = options.timeoutMs -
+                       static_cast<int32>(millisecondsSince(worker.start));
+      timeoutMs = std::min(timeoutMs, std::max(remaining, 0));
+    }
+    if (poll(pollFDs.data(), pollFDs.size(), timeoutMs) < 0 &&
+        errno != EINTR) {
+      // kill and reap the workers, modules not started yet keep the
+      // default failed report
+      std::string error = std::string("poll failed: ") + strerror(errno);
+      for (auto &worker : workers) {
+        auto &report = reports[worker.index];
+        finishWorker(worker, true, cache, report);
+        report.status = PluginScanReport::Status::kFailed;
+        report.error = error;
+      }
+      for (; next != pending.end(); ++next)
+        reports[*next].error = error;
+      break;
+    }
+
+    for (size_t i = workers.size(); i-- > 0;) {
+      auto &worker = workers[i];
+      auto finished = false;
+      if (pollFDs[i].revents != 0) {
+        char buffer[PIPE_BUF];
+        auto count = read(worker.errorFD, buffer, sizeof(buffer));
+        if (count > 0)
+          worker.error.append(buffer, static_cast<size_t>(count));
+        else
+          finished = true;
+      }
+      auto timedOut =
+          !finished && millisecondsSince(worker.start) >= options.timeoutMs;
+      if (finished || timedOut) {
+        finishWorker(worker, timedOut, cache, reports[worker.index]);
+        workers.erase(workers.begin() + static_cast<ptrdiff_t>(i));
+      }
+    }
+  }
+  return reports;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "source/scancache.h"
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+struct PluginScanOptions {
+  //! Number of worker processes, 0 for one per CPU.
+  int32 numWorkers = 0;
+  //! A worker that takes longer than this for one module is killed.
+  int32 timeoutMs = 30000;
+  //! Scan modules again even if the cache has a current scanned entry.
+  bool rescan = false;
+  //! Handed to the plug-in factories, see PluginFactory::setHostContext.
+  FUnknown *hostContext = nullptr;
+};
+
+//------------------------------------------------------------------------
+struct PluginScanReport {
+  enum class Status { kCached, kScanned, kFailed, kCrashed, kTimedOut };
+
+  std::string path;
+  Status status = Status::kFailed;
+  std::string error;
+  //! Time spent in VST3::Hosting::Module::create, negative if unknown.
+  double loadTimeMs = -1.;
+  //! Wall clock time of the worker process including all probing.
+  double totalTimeMs = 0.;
+  size_t numClasses = 0;
+};
+
+using PluginScanReports = std::vector<PluginScanReport>;
+
+//------------------------------------------------------------------------
+//! Returns the .vst3 bundles below directory, sorted. Bundles are not
+//! searched for further bundles.
+std::vector<std::string> findModulePaths(const std::string &directory);
+
+/** Scans modules in forked worker processes and stores them in cache.
+ *
+ *  Each worker loads one module, walks its factory and instantiates every
+ *  audio module class to read its busses and parameter count. A module
+ *  that crashes or exceeds the timeout only fails its own report.
+ */
+PluginScanReports scanPlugins(const std::vector<std::string> &modulePaths,
+                              ScanCache &cache,
+                              const PluginScanOptions &options);
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
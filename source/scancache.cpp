@@ -0,0 +1,409 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#include "source/scancache.h"
+#include "pluginterfaces/vst/ivstcomponent.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+#include "public.sdk/source/vst/hosting/module.h"
+#include "public.sdk/source/vst/moduleinfo/moduleinfoparser.h"
+#include "source/toml11/toml.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+//------------------------------------------------------------------------
+static std::string normalizeUID(const std::string &uid) {
+  if (auto id = VST3::UID::fromString(uid))
+    return id->toString();
+  return uid;
+}
+
+//------------------------------------------------------------------------
+static toml::value toArray(const std::vector<int32> &values) {
+  toml::array result;
+  for (auto value : values)
+    result.emplace_back(static_cast<toml::value::integer_type>(value));
+  return toml::value(std::move(result));
+}
+
+//------------------------------------------------------------------------
+static std::vector<int32> fromArray(const toml::value &value) {
+  std::vector<int32> result;
+  for (const auto &item : value.as_array())
+    result.push_back(static_cast<int32>(item.as_integer()));
+  return result;
+}
+
+//------------------------------------------------------------------------
+static bool writeFile(const std::string &path, const std::string &content,
+                      std::string &error) {
+  auto tempPath = path + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::trunc | std::ios::binary);
+    if (!file) {
+      error = "Could not create " + tempPath;
+      return false;
+    }
+    if (!file.write(content.data(), content.size()).flush()) {
+      error = "Could not write " + tempPath;
+      std::remove(tempPath.data());
+      return false;
+    }
+  }
+  if (std::rename(tempPath.data(), path.data()) != 0) {
+    error = "Could not replace " + path;
+    std::remove(tempPath.data());
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+const ScannedClass *ScannedModule::findClass(const std::string &uid) const {
+  for (const auto &scannedClass : classes) {
+    if (scannedClass.uid == uid)
+      return &scannedClass;
+  }
+  return nullptr;
+}
+
+//------------------------------------------------------------------------
+ScannedClass *ScannedModule::findClass(const std::string &uid) {
+  const auto &self = *this;
+  return const_cast<ScannedClass *>(self.findClass(uid));
+}
+
+//------------------------------------------------------------------------
+std::string ScanCache::defaultPath() {
+  std::string directory;
+  if (auto cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome)
+    directory = cacheHome;
+  else if (auto home = std::getenv("HOME"); home && *home)
+    directory = std::string(home) + "/.cache";
+  else
+    return {};
+  mkdir(directory.data(), 0755);
+  directory += "/min-vst-host";
+  mkdir(directory.data(), 0755);
+  return directory + "/scancache";
+}
+
+//------------------------------------------------------------------------
+bool ScanCache::load(const std::string &path, std::string &error) {
+  filePath = path;
+  modules.clear();
+  modified = false;
+
+  struct stat info {};
+  if (stat(path.data(), &info) != 0)
+    return true;
+
+  try {
+    auto root = toml::parse(path);
+    if (!root.contains("module"))
+      return true;
+    for (const auto &table : root.at("module").as_array()) {
+      auto modulePath = table.at("path").as_string();
+      auto &module = modules[modulePath];
+      module.path = modulePath;
+      module.mtime = table.at("mtime").as_integer();
+      module.size = table.at("size").as_integer();
+      module.fromModuleInfo = table.at("module_info").as_boolean();
+      if (table.contains("load_ms"))
+        module.loadTimeMs = table.at("load_ms").as_floating();
+      if (!table.contains("class"))
+        continue;
+      for (const auto &classTable : table.at("class").as_array()) {
+        ScannedClass scannedClass;
+        scannedClass.uid = classTable.at("uid").as_string();
+        scannedClass.name = classTable.at("name").as_string();
+        scannedClass.category = classTable.at("category").as_string();
+        scannedClass.subCategories =
+            classTable.at("sub_categories").as_string();
+        scannedClass.vendor = classTable.at("vendor").as_string();
+        if (classTable.contains("parameters")) {
+          scannedClass.audioInputs = fromArray(classTable.at("audio_inputs"));
+          scannedClass.audioOutputs =
+              fromArray(classTable.at("audio_outputs"));
+          scannedClass.eventInputs =
+              static_cast<int32>(classTable.at("event_inputs").as_integer());
+          scannedClass.parameterCount =
+              static_cast<int32>(classTable.at("parameters").as_integer());
+        }
+        module.classes.push_back(std::move(scannedClass));
+      }
+    }
+  } catch (const std::exception &e) {
+    modules.clear();
+    error = e.what();
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------
+bool ScanCache::save(std::string &error) {
+  if (!modified || filePath.empty())
+    return true;
+
+  toml::array moduleTables;
+  for (const auto &entry : modules) {
+    const auto &module = entry.second;
+    toml::value moduleTable(toml::table{});
+    moduleTable["path"] = module.path;
+    moduleTable["mtime"] = module.mtime;
+    moduleTable["size"] = module.size;
+    moduleTable["module_info"] = module.fromModuleInfo;
+    if (module.loadTimeMs >= 0.)
+      moduleTable["load_ms"] = module.loadTimeMs;
+
+    toml::array classTables;
+    for (const auto &scannedClass : module.classes) {
+      toml::value classTable(toml::table{});
+      classTable["uid"] = scannedClass.uid;
+      classTable["name"] = scannedClass.name;
+      classTable["category"] = scannedClass.category;
+      classTable["sub_categories"] = scannedClass.subCategories;
+      classTable["vendor"] = scannedClass.vendor;
+      if (scannedClass.isProbed()) {
+        classTable["audio_inputs"] = toArray(scannedClass.audioInputs);
+        classTable["audio_outputs"] = toArray(scannedClass.audioOutputs);
+        classTable["event_inputs"] = scannedClass.eventInputs;
+        classTable["parameters"] = scannedClass.parameterCount;
+      }
+      classTables.push_back(std::move(classTable));
+    }
+    if (!classTables.empty())
+      moduleTable["class"] = std::move(classTables);
+    moduleTables.push_back(std::move(moduleTable));
+  }
+  toml::value root(toml::table{});
+  root["module"] = std::move(moduleTables);
+
+  std::string content;
+  try {
+    content = toml::format(root);
+  } catch (const std::exception &e) {
+    error = e.what();
+    return false;
+  }
+  if (!writeFile(filePath, content, error))
+    return false;
+  modified = false;
+  return true;
+}
+
+//------------------------------------------------------------------------
+const ScannedModule *ScanCache::find(const std::string &modulePath) const {
+  auto it = modules.find(modulePath);
+  if (it == modules.end())
+    return nullptr;
+  int64_t mtime = 0;
+  int64_t size = 0;
+  if (!statModule(modulePath, mtime, size) || it->second.mtime != mtime ||
+      it->second.size != size)
+    return nullptr;
+  return &it->second;
+}
+
+//------------------------------------------------------------------------
+ScannedModule *ScanCache::update(const std::string &modulePath,
+                                 const VST3::Hosting::Module &loadedModule,
+                                 std::string &error) {
+  if (find(modulePath))
+    return &modules[modulePath];
+
+  ScannedModule module;
+  if (!scanLoadedModule(modulePath, loadedModule, module, error))
+    return nullptr;
+  store(std::move(module));
+  return &modules[modulePath];
+}
+
+//------------------------------------------------------------------------
+void ScanCache::store(ScannedModule module) {
+  auto path = module.path;
+  modules[path] = std::move(module);
+  modified = true;
+}
+
+//------------------------------------------------------------------------
+const ScannedModule *
+ScanCache::findModuleOfClass(const std::string &uid) const {
+  auto normalized = normalizeUID(uid);
+  for (const auto &entry : modules) {
+    if (entry.second.findClass(normalized))
+      return &entry.second;
+  }
+  return nullptr;
+}
+
+//------------------------------------------------------------------------
+std::string getModuleBinaryPath(const std::string &modulePath) {
+  struct stat info {};
+  if (stat(modulePath.data(), &info) != 0 || !S_ISDIR(info.st_mode))
+    return modulePath;
+
+  // <name>.vst3/Contents/<machine>-linux/<name>.so
+  auto path = modulePath;
+  while (path.size() > 1 && path.back() == '/')
+    path.pop_back();
+  auto name = path.substr(path.find_last_of('/') + 1);
+  auto extension = name.rfind(".vst3");
+  if (extension != std::string::npos)
+    name.erase(extension);
+
+  struct utsname machine {};
+  uname(&machine);
+  return path + "/Contents/" + machine.machine + "-linux/" + name + ".so";
+}
+
+//------------------------------------------------------------------------
+bool statModule(const std::string &modulePath, int64_t &mtime,
+                int64_t &size) {
+  struct stat info {};
+  if (stat(getModuleBinaryPath(modulePath).data(), &info) != 0)
+    return false;
+  mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 +
+          info.st_mtim.tv_nsec;
+  size = static_cast<int64_t>(info.st_size);
+  return true;
+}
+
+//------------------------------------------------------------------------
+static bool readModuleInfo(const std::string &modulePath,
+                           ScannedModule &module) {
+  auto infoPath = VST3::Hosting::Module::getModuleInfoPath(modulePath);
+  if (!infoPath)
+    return false;
+  std::ifstream file(*infoPath, std::ios::binary);
+  if (!file)
+    return false;
+  std::ostringstream json;
+  json << file.rdbuf();
+  auto moduleInfo = ModuleInfoLib::parseJson(json.str(), nullptr);
+  if (!moduleInfo)
+    return false;
+
+  for (const auto &classInfo : moduleInfo->classes) {
+    ScannedClass scannedClass;
+    scannedClass.uid = normalizeUID(classInfo.cid);
+    scannedClass.name = classInfo.name;
+    scannedClass.category = classInfo.category;
+    for (const auto &subCategory : classInfo.subCategories) {
+      if (!scannedClass.subCategories.empty())
+        scannedClass.subCategories += '|';
+      scannedClass.subCategories += subCategory;
+    }
+    scannedClass.vendor = classInfo.vendor;
+    module.classes.push_back(std::move(scannedClass));
+  }
+  module.fromModuleInfo = true;
+  return true;
+}
+
+//------------------------------------------------------------------------
+static void readFactory(const VST3::Hosting::Module &pluginModule,
+                        ScannedModule &module) {
+  for (const auto &classInfo : pluginModule.getFactory().classInfos())
+    module.classes.push_back(makeScannedClass(classInfo));
+  module.fromModuleInfo = false;
+}
+
+//------------------------------------------------------------------------
+static bool statScannedModule(const std::string &modulePath,
+                              ScannedModule &module, std::string &error) {
+  module = {};
+  module.path = modulePath;
+  if (statModule(modulePath, module.mtime, module.size))
+    return true;
+  error = "Could not find module binary of " + modulePath;
+  return false;
+}
+
+//------------------------------------------------------------------------
+bool scanModuleInfo(const std::string &modulePath, ScannedModule &module) {
+  std::string error;
+  return statScannedModule(modulePath, module, error) &&
+         readModuleInfo(modulePath, module);
+}
+
+//------------------------------------------------------------------------
+bool scanLoadedModule(const std::string &modulePath,
+                      const VST3::Hosting::Module &loadedModule,
+                      ScannedModule &module, std::string &error) {
+  if (!statScannedModule(modulePath, module, error))
+    return false;
+  if (!readModuleInfo(modulePath, module))
+    readFactory(loadedModule, module);
+  return true;
+}
+
+//------------------------------------------------------------------------
+ScannedClass makeScannedClass(const VST3::Hosting::ClassInfo &classInfo) {
+  ScannedClass scannedClass;
+  scannedClass.uid = classInfo.ID().toString();
+  scannedClass.name = classInfo.name();
+  scannedClass.category = classInfo.category();
+  scannedClass.subCategories = classInfo.subCategoriesString();
+  scannedClass.vendor = classInfo.vendor();
+  return scannedClass;
+}
+
+//------------------------------------------------------------------------
+void probeScannedClass(IComponent *component, IEditController *controller,
+                       ScannedClass &scannedClass) {
+  auto channelCounts = [&](BusDirection direction) {
+    std::vector<int32> counts;
+    auto numBusses = component->getBusCount(kAudio, direction);
+    for (int32 i = 0; i < numBusses; ++i) {
+      BusInfo info{};
+      component->getBusInfo(kAudio, direction, i, info);
+      counts.push_back(info.channelCount);
+    }
+    return counts;
+  };
+  scannedClass.audioInputs = channelCounts(kInput);
+  scannedClass.audioOutputs = channelCounts(kOutput);
+  scannedClass.eventInputs = component->getBusCount(kEvent, kInput);
+  scannedClass.parameterCount =
+      controller ? controller->getParameterCount() : 0;
+}
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg
@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------------------
+// LICENSE
+// (c) 2024, Steinberg Media Technologies GmbH, All Rights Reserved
+//-----------------------------------------------------------------------------
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//   * Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//   * Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//   * Neither the name of the Steinberg Media Technologies nor the names of its
+//     contributors may be used to endorse or promote products derived from this
+//     software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "pluginterfaces/base/ftypes.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace VST3 {
+namespace Hosting {
+class ClassInfo;
+class Module;
+} // namespace Hosting
+} // namespace VST3
+
+//------------------------------------------------------------------------
+namespace Steinberg {
+namespace Vst {
+
+class IComponent;
+class IEditController;
+
+//------------------------------------------------------------------------
+struct ScannedClass {
+  //! Class ID as printed by VST3::UID::toString.
+  std::string uid;
+  std::string name;
+  std::string category;
+  std::string subCategories;
+  std::string vendor;
+  //! Channel count per audio bus and number of event input busses. Only
+  //! known once the class was instantiated, see probeScannedClass.
+  std::vector<int32> audioInputs;
+  std::vector<int32> audioOutputs;
+  int32 eventInputs = -1;
+  int32 parameterCount = -1;
+
+  bool isProbed() const { return parameterCount >= 0; }
+};
+
+//------------------------------------------------------------------------
+struct ScannedModule {
+  std::string path;
+  //! Modification time and size of the module binary the entry was made
+  //! from; the entry is stale as soon as one of them changes.
+  int64_t mtime = 0;
+  int64_t size = 0;
+  //! The classes were read from moduleinfo.json without loading the binary.
+  bool fromModuleInfo = false;
+  //! Time it took to load the module binary when it was scanned in
+  //! milliseconds, negative if it was not loaded or not timed.
+  double loadTimeMs = -1.;
+  std::vector<ScannedClass> classes;
+
+  const ScannedClass *findClass(const std::string &uid) const;
+  ScannedClass *findClass(const std::string &uid);
+};
+
+//------------------------------------------------------------------------
+/** Persistent index of scanned plug-in modules.
+ *
+ *  Entries are keyed by module path and validated against the mtime and
+ *  size of the module binary. The file is TOML with a [[module]] table per
+ *  module holding a [[module.class]] table per class.
+ */
+class ScanCache {
+public:
+  //! Default location below $XDG_CACHE_HOME or ~/.cache.
+  static std::string defaultPath();
+
+  //! A missing file yields an empty cache and is no error.
+  bool load(const std::string &path, std::string &error);
+  //! Writes the cache back if it was modified since load.
+  bool save(std::string &error);
+
+  //! Returns the entry for modulePath if it matches the module on disk.
+  const ScannedModule *find(const std::string &modulePath) const;
+  //! Returns an up to date entry for modulePath, filling a missing or stale
+  //! one from loadedModule, the module at modulePath the caller loaded
+  //! anyway. Returns nullptr if the module binary is missing.
+  ScannedModule *update(const std::string &modulePath,
+                        const VST3::Hosting::Module &loadedModule,
+                        std::string &error);
+  //! Replaces the entry of module.path.
+  void store(ScannedModule module);
+
+  //! Searches all entries for a class ID, stale ones included.
+  const ScannedModule *findModuleOfClass(const std::string &uid) const;
+
+  bool isModified() const { return modified; }
+  void setModified() { modified = true; }
+
+private:
+  std::string filePath;
+  std::map<std::string, ScannedModule> modules;
+  bool modified = false;
+};
+
+//------------------------------------------------------------------------
+//! Path of the shared library inside a .vst3 bundle, or path itself.
+std::string getModuleBinaryPath(const std::string &modulePath);
+
+//! Reads mtime and size of the module binary. Returns false if missing.
+bool statModule(const std::string &modulePath, int64_t &mtime, int64_t &size);
+
+//! Fills module from the bundle's moduleinfo.json without loading the
+//! module binary. Returns false if there is no moduleinfo.json.
+bool scanModuleInfo(const std::string &modulePath, ScannedModule &module);
+
+//! Fills module from the bundle's moduleinfo.json if there is one, from the
+//! factory of the already loaded module otherwise.
+bool scanLoadedModule(const std::string &modulePath,
+                      const VST3::Hosting::Module &loadedModule,
+                      ScannedModule &module, std::string &error);
+
+//! Copies the factory's description of a class.
+ScannedClass makeScannedClass(const VST3::Hosting::ClassInfo &classInfo);
+
+//! Fills the bus layout and parameter count of an instantiated class.
+void probeScannedClass(IComponent *component, IEditController *controller,
+                       ScannedClass &scannedClass);
+
+//------------------------------------------------------------------------
+} // namespace Vst
+} // namespace Steinberg